@@ -1,3 +1,4 @@
+#include <atomic>
 #include <cstdio>
 #include <optional>
 #include <tuple>
@@ -11,9 +12,11 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <string.h>
+#include <sys/stat.h>
 
 extern "C" {
 #include <libavcodec/avcodec.h>
+#include <libavcodec/bsf.h>
 #include <libavcodec/codec.h>
 #include <libavcodec/codec_id.h>
 #include <libavcodec/codec_par.h>
@@ -25,6 +28,7 @@ extern "C" {
 #include <libavformat/avformat.h>
 #include <libavformat/avio.h>
 #include <libavutil/audio_fifo.h>
+#include <libavutil/buffer.h>
 #include <libavutil/channel_layout.h>
 #include <libavutil/dict.h>
 #include <libavutil/error.h>
@@ -46,7 +50,46 @@ extern "C" {
 using bare_ffmpeg_io_context_write_cb_t = js_function_t<void, js_arraybuffer_t>;
 using bare_ffmpeg_io_context_read_cb_t = js_function_t<int32_t, js_arraybuffer_t, int32_t>;
 using bare_ffmpeg_io_context_seek_cb_t = js_function_t<int64_t, int64_t, int>;
+using bare_ffmpeg_io_context_drain_cb_t = js_function_t<void>;
 using bare_ffmpeg_codec_context_get_format_cb_t = js_function_t<int, std::vector<int>>;
+using bare_ffmpeg_codec_context_job_cb_t = js_function_t<void, int32_t>;
+using bare_ffmpeg_codec_context_encode_cb_t = js_function_t<void, int32_t, std::vector<js_arraybuffer_t>>;
+using bare_ffmpeg_remux_progress_cb_t = js_function_t<bool, int64_t, int64_t>;
+using bare_ffmpeg_remux_cb_t = js_function_t<void, int32_t, int64_t>;
+using bare_ffmpeg_scaler_job_cb_t = js_function_t<void, int32_t>;
+using bare_ffmpeg_format_context_job_cb_t = js_function_t<void, int32_t>;
+
+typedef struct {
+  std::atomic<bool> aborted;
+  std::atomic<uint64_t> deadline;
+
+  uint64_t timeout;
+} bare_ffmpeg_interrupt_t;
+
+typedef struct {
+  uv_async_t drain;
+
+  js_env_t *env;
+
+  uv_mutex_t lock;
+  uv_cond_t readable;
+
+  uv_thread_t loop_thread;
+
+  uint8_t *data;
+  size_t capacity;
+  size_t start;
+  size_t length;
+
+  size_t high_water_mark;
+
+  bool needs_drain;
+  bool ended;
+
+  bare_ffmpeg_interrupt_t *interrupt;
+
+  js_persistent_t<bare_ffmpeg_io_context_drain_cb_t> on_drain;
+} bare_ffmpeg_io_stream_t;
 
 typedef struct {
   AVIOContext *handle;
@@ -56,8 +99,45 @@ typedef struct {
   js_persistent_t<bare_ffmpeg_io_context_write_cb_t> on_write;
   js_persistent_t<bare_ffmpeg_io_context_read_cb_t> on_read;
   js_persistent_t<bare_ffmpeg_io_context_seek_cb_t> on_seek;
+
+  uv_file fd;
+  bool owns_fd;
+
+  js_persistent_t<js_arraybuffer_t> source;
+  const uint8_t *data;
+
+  int64_t size;
+  int64_t position;
+
+  bare_ffmpeg_io_stream_t *stream;
+
+  AVBufferPool *write_pool;
+  AVBufferRef *write_chunk;
+
+  size_t write_size;
+  size_t write_length;
 } bare_ffmpeg_io_context_t;
 
+typedef struct bare_ffmpeg_pin_s bare_ffmpeg_pin_t;
+
+typedef struct {
+  uv_async_t handle;
+
+  uv_mutex_t lock;
+
+  std::vector<bare_ffmpeg_pin_t *> released;
+
+  size_t pins;
+  bool closed;
+  bool detached;
+} bare_ffmpeg_pin_queue_t;
+
+struct bare_ffmpeg_pin_s {
+  bare_ffmpeg_pin_queue_t *queue;
+
+  js_persistent_t<js_arraybuffer_t> buffer;
+};
+
 typedef struct {
   const AVOutputFormat *handle;
 } bare_ffmpeg_output_format_t;
@@ -68,8 +148,42 @@ typedef struct {
 
 typedef struct {
   AVFormatContext *handle;
+
+  bool owns_io;
+
+  bare_ffmpeg_interrupt_t interrupt;
+
+  // An error hit after part of a batch was read, reported by the next read
+  int deferred_status;
 } bare_ffmpeg_format_context_t;
 
+typedef struct {
+  uv_work_t handle;
+  uv_async_t progress;
+
+  js_env_t *env;
+
+  AVFormatContext *input;
+  AVFormatContext *output;
+
+  std::vector<int32_t> stream_map;
+
+  int64_t start_time;
+  int64_t end_time;
+
+  std::atomic<int64_t> time;
+  std::atomic<int64_t> packets;
+  std::atomic<bool> cancelled;
+
+  bool threaded;
+  int status;
+
+  js_persistent_t<js_arraybuffer_t> input_ref;
+  js_persistent_t<js_arraybuffer_t> output_ref;
+  js_persistent_t<bare_ffmpeg_remux_progress_cb_t> on_progress;
+  js_persistent_t<bare_ffmpeg_remux_cb_t> on_complete;
+} bare_ffmpeg_remux_job_t;
+
 typedef struct {
   AVStream *handle;
 } bare_ffmpeg_stream_t;
@@ -82,28 +196,203 @@ typedef struct {
   AVCodecParameters *handle;
 } bare_ffmpeg_codec_parameters_t;
 
+typedef struct {
+  AVBufferPool *pools[4];
+  size_t sizes[4];
+  int linesize[4];
+
+  int format;
+  int width;
+  int height;
+  int align;
+} bare_ffmpeg_codec_context_buffer_pool_t;
+
+struct bare_ffmpeg_codec_context_job_s;
+
 typedef struct {
   AVCodecContext *handle;
   js_env_t *env;
   js_persistent_t<bare_ffmpeg_codec_context_get_format_cb_t> get_format_cb;
+  bare_ffmpeg_codec_context_buffer_pool_t *buffer_pool;
+
+  // Asynchronous operations run one at a time, in the order they were issued
+  struct bare_ffmpeg_codec_context_job_s *queue_head;
+  struct bare_ffmpeg_codec_context_job_s *queue_tail;
 } bare_ffmpeg_codec_context_t;
 
 typedef struct {
   AVChannelLayout handle;
 } bare_ffmpeg_channel_layout_t;
 
+typedef struct {
+  double pts;
+  double pkt_dts;
+  int32_t width;
+  int32_t height;
+  int32_t format;
+  int32_t nb_samples;
+  int32_t sample_rate;
+  int32_t pict_type;
+  int32_t time_base_num;
+  int32_t time_base_den;
+  int32_t linesize[AV_NUM_DATA_POINTERS];
+} bare_ffmpeg_frame_header_t;
+
 typedef struct {
   AVFrame *handle;
+  alignas(8) bare_ffmpeg_frame_header_t header;
 } bare_ffmpeg_frame_t;
 
+typedef struct {
+  double pts;
+  double dts;
+  double duration;
+  int32_t stream_index;
+  int32_t flags;
+  int32_t size;
+  int32_t time_base_num;
+  int32_t time_base_den;
+} bare_ffmpeg_packet_header_t;
+
 typedef struct {
   AVPacket *handle;
+  alignas(8) bare_ffmpeg_packet_header_t header;
 } bare_ffmpeg_packet_t;
 
+#define BARE_FFMPEG_FRAME_HEADER_OFFSET  offsetof(bare_ffmpeg_frame_t, header)
+#define BARE_FFMPEG_FRAME_FIELDS_OFFSET  offsetof(bare_ffmpeg_frame_t, header.width)
+#define BARE_FFMPEG_PACKET_HEADER_OFFSET offsetof(bare_ffmpeg_packet_t, header)
+#define BARE_FFMPEG_PACKET_FIELDS_OFFSET offsetof(bare_ffmpeg_packet_t, header.stream_index)
+
+// The headers are viewed from JavaScript through a Float64Array, which must
+// start at a multiple of 8 bytes, even where doubles are only 4-byte aligned
+static_assert(BARE_FFMPEG_FRAME_HEADER_OFFSET % 8 == 0, "Misaligned frame header");
+static_assert(BARE_FFMPEG_PACKET_HEADER_OFFSET % 8 == 0, "Misaligned packet header");
+static_assert(BARE_FFMPEG_FRAME_FIELDS_OFFSET % 4 == 0, "Misaligned frame header fields");
+static_assert(BARE_FFMPEG_PACKET_FIELDS_OFFSET % 4 == 0, "Misaligned packet header fields");
+
+typedef struct bare_ffmpeg_codec_context_job_s {
+  uv_work_t handle;
+
+  js_env_t *env;
+
+  bare_ffmpeg_codec_context_t *owner;
+
+  AVCodecContext *context;
+  AVPacket *packet;
+  AVFrame *frame;
+
+  bare_ffmpeg_frame_t *target_frame;
+  bare_ffmpeg_packet_t *target_packet;
+
+  std::vector<AVPacket *> packets;
+
+  int status;
+
+  uv_work_cb work;
+  uv_after_work_cb done;
+
+  struct bare_ffmpeg_codec_context_job_s *next;
+
+  js_persistent_t<js_arraybuffer_t> context_ref;
+  js_persistent_t<js_arraybuffer_t> target_ref;
+  js_persistent_t<bare_ffmpeg_codec_context_job_cb_t> on_complete;
+  js_persistent_t<bare_ffmpeg_codec_context_encode_cb_t> on_encode;
+} bare_ffmpeg_codec_context_job_t;
+
+typedef struct {
+  uv_work_t handle;
+
+  js_env_t *env;
+
+  bare_ffmpeg_format_context_t *context;
+
+  AVPacket *packet;
+
+  bare_ffmpeg_packet_t *target_packet;
+
+  int status;
+
+  bool find_stream_info;
+
+  js_persistent_t<js_arraybuffer_t> context_ref;
+  js_persistent_t<js_arraybuffer_t> target_ref;
+  js_persistent_t<bare_ffmpeg_format_context_job_cb_t> on_complete;
+} bare_ffmpeg_format_context_job_t;
+
+struct bare_ffmpeg_scaler_task_s;
+
 typedef struct {
   struct SwsContext *handle;
+
+  // Asynchronous operations run one at a time, in the order they were issued
+  struct bare_ffmpeg_scaler_task_s *queue_head;
+  struct bare_ffmpeg_scaler_task_s *queue_tail;
 } bare_ffmpeg_scaler_t;
 
+// The part of an asynchronous operation that uses a single scaler, either a
+// whole scale or one rung of a ladder
+typedef struct bare_ffmpeg_scaler_task_s {
+  uv_work_t handle;
+
+  bare_ffmpeg_scaler_t *owner;
+
+  uv_work_cb work;
+  uv_after_work_cb done;
+
+  struct bare_ffmpeg_scaler_task_s *next;
+} bare_ffmpeg_scaler_task_t;
+
+typedef struct {
+  bare_ffmpeg_scaler_task_t task;
+
+  js_env_t *env;
+
+  struct SwsContext *context;
+
+  AVFrame *source;
+  AVFrame *target;
+
+  bare_ffmpeg_frame_t *target_frame;
+
+  bool allocate;
+  int status;
+
+  js_persistent_t<js_arraybuffer_t> scaler_ref;
+  js_persistent_t<js_arraybuffer_t> target_ref;
+  std::vector<js_persistent_t<js_arraybuffer_t>> memory_refs;
+  js_persistent_t<bare_ffmpeg_scaler_job_cb_t> on_complete;
+} bare_ffmpeg_scaler_job_t;
+
+typedef struct {
+  bare_ffmpeg_scaler_task_t task;
+
+  struct SwsContext *context;
+
+  AVFrame *target;
+
+  bare_ffmpeg_frame_t *target_frame;
+
+  bool allocate;
+  int status;
+
+  js_persistent_t<js_arraybuffer_t> scaler_ref;
+  js_persistent_t<js_arraybuffer_t> target_ref;
+} bare_ffmpeg_scaler_ladder_rung_t;
+
+typedef struct {
+  js_env_t *env;
+
+  AVFrame *source;
+
+  std::vector<bare_ffmpeg_scaler_ladder_rung_t> rungs;
+
+  size_t pending;
+
+  std::vector<js_persistent_t<js_arraybuffer_t>> memory_refs;
+  js_persistent_t<bare_ffmpeg_scaler_job_cb_t> on_complete;
+} bare_ffmpeg_scaler_ladder_job_t;
+
 typedef struct {
   struct AVDictionary *handle;
 } bare_ffmpeg_dictionary_t;
@@ -116,6 +405,30 @@ typedef struct {
   AVAudioFifo *handle;
 } bare_ffmpeg_audio_fifo_t;
 
+typedef struct {
+  AVBSFContext *handle;
+} bare_ffmpeg_bitstream_filter_t;
+
+typedef struct {
+  AVBufferPool *handle;
+
+  int32_t format;
+  int32_t width;
+  int32_t height;
+  int32_t nb_samples;
+  int32_t align;
+
+  AVChannelLayout ch_layout;
+} bare_ffmpeg_frame_pool_t;
+
+#define BARE_FFMPEG_PACKET_POOL_CLASSES 16
+
+typedef struct {
+  AVBufferPool *classes[BARE_FFMPEG_PACKET_POOL_CLASSES];
+
+  int32_t min_size;
+} bare_ffmpeg_packet_pool_t;
+
 typedef struct {
   AVPacketSideData *handle;
 } bare_ffmpeg_side_data_t;
@@ -152,6 +465,40 @@ typedef struct {
   AVHWFramesConstraints *handle;
 } bare_ffmpeg_hw_frames_constraints_t;
 
+// Mirror the commonly read fields into the header that JavaScript reads
+// directly from the handle. Must be called whenever the underlying frame or
+// packet is modified.
+
+static void
+bare_ffmpeg__frame_sync(AVFrame *frame, bare_ffmpeg_frame_header_t &header) {
+  header.pts = frame->pts == AV_NOPTS_VALUE ? -1 : static_cast<double>(frame->pts);
+  header.pkt_dts = frame->pkt_dts == AV_NOPTS_VALUE ? -1 : static_cast<double>(frame->pkt_dts);
+  header.width = frame->width;
+  header.height = frame->height;
+  header.format = frame->format;
+  header.nb_samples = frame->nb_samples;
+  header.sample_rate = frame->sample_rate;
+  header.pict_type = frame->pict_type;
+  header.time_base_num = frame->time_base.num;
+  header.time_base_den = frame->time_base.den;
+
+  for (int i = 0; i < AV_NUM_DATA_POINTERS; i++) {
+    header.linesize[i] = frame->linesize[i];
+  }
+}
+
+static void
+bare_ffmpeg__packet_sync(AVPacket *packet, bare_ffmpeg_packet_header_t &header) {
+  header.pts = packet->pts == AV_NOPTS_VALUE ? -1 : static_cast<double>(packet->pts);
+  header.dts = packet->dts == AV_NOPTS_VALUE ? -1 : static_cast<double>(packet->dts);
+  header.duration = static_cast<double>(packet->duration);
+  header.stream_index = packet->stream_index;
+  header.flags = packet->flags;
+  header.size = packet->size;
+  header.time_base_num = packet->time_base.num;
+  header.time_base_den = packet->time_base.den;
+}
+
 static uv_once_t bare_ffmpeg__init_guard = UV_ONCE_INIT;
 
 static void
@@ -171,6 +518,174 @@ bare_ffmpeg_log_set_level(js_env_t *, int32_t level) {
   av_log_set_level(level);
 }
 
+static std::string
+bare_ffmpeg_get_error_string(js_env_t *, int32_t code) {
+  return av_err2str(code);
+}
+
+// Pins of the current environment are released through a single async
+// handle, as JavaScript environments each run on their own thread.
+static thread_local bare_ffmpeg_pin_queue_t *bare_ffmpeg__pin_queue = NULL;
+
+static void
+bare_ffmpeg__on_pin_queue_close(uv_handle_t *handle) {
+  auto queue = reinterpret_cast<bare_ffmpeg_pin_queue_t *>(handle);
+
+  uv_mutex_lock(&queue->lock);
+
+  queue->detached = true;
+
+  // Buffers still held by FFmpeg free the queue once they are released
+  bool unused = queue->pins == 0;
+
+  uv_mutex_unlock(&queue->lock);
+
+  if (unused) {
+    uv_mutex_destroy(&queue->lock);
+
+    delete queue;
+  }
+}
+
+static void
+bare_ffmpeg__on_pin_queue_drain(uv_async_t *handle) {
+  auto queue = reinterpret_cast<bare_ffmpeg_pin_queue_t *>(handle);
+
+  std::vector<bare_ffmpeg_pin_t *> released;
+
+  uv_mutex_lock(&queue->lock);
+
+  released.swap(queue->released);
+
+  queue->pins -= released.size();
+
+  uv_mutex_unlock(&queue->lock);
+
+  for (auto pin : released) {
+    pin->buffer.reset();
+
+    delete pin;
+  }
+}
+
+static void
+bare_ffmpeg__on_pin_queue_teardown(void *data) {
+  auto queue = static_cast<bare_ffmpeg_pin_queue_t *>(data);
+
+  bare_ffmpeg__on_pin_queue_drain(&queue->handle);
+
+  uv_mutex_lock(&queue->lock);
+
+  queue->closed = true;
+
+  uv_mutex_unlock(&queue->lock);
+
+  bare_ffmpeg__pin_queue = NULL;
+
+  uv_close(reinterpret_cast<uv_handle_t *>(&queue->handle), bare_ffmpeg__on_pin_queue_close);
+}
+
+static bare_ffmpeg_pin_queue_t *
+bare_ffmpeg__pin_queue_get(js_env_t *env) {
+  int err;
+
+  if (bare_ffmpeg__pin_queue) return bare_ffmpeg__pin_queue;
+
+  uv_loop_t *loop;
+  err = js_get_env_loop(env, &loop);
+  assert(err == 0);
+
+  auto queue = new bare_ffmpeg_pin_queue_t();
+
+  err = uv_mutex_init(&queue->lock);
+  assert(err == 0);
+
+  err = uv_async_init(loop, &queue->handle, bare_ffmpeg__on_pin_queue_drain);
+  assert(err == 0);
+
+  uv_unref(reinterpret_cast<uv_handle_t *>(&queue->handle));
+
+  err = js_add_teardown_callback(env, bare_ffmpeg__on_pin_queue_teardown, queue);
+  assert(err == 0);
+
+  bare_ffmpeg__pin_queue = queue;
+
+  return queue;
+}
+
+static void
+bare_ffmpeg__on_pin_free(void *opaque, uint8_t *data) {
+  int err;
+
+  auto pin = static_cast<bare_ffmpeg_pin_t *>(opaque);
+
+  auto queue = pin->queue;
+
+  uv_mutex_lock(&queue->lock);
+
+  if (queue->closed) {
+    // The environment is gone along with the reference, so only the queue
+    // itself is left to free
+    bool unused = --queue->pins == 0 && queue->detached;
+
+    uv_mutex_unlock(&queue->lock);
+
+    if (unused) {
+      uv_mutex_destroy(&queue->lock);
+
+      delete queue;
+    }
+
+    return;
+  }
+
+  // The last reference may be dropped from a codec thread, so defer releasing
+  // the ArrayBuffer to the loop thread.
+  queue->released.push_back(pin);
+
+  uv_mutex_unlock(&queue->lock);
+
+  err = uv_async_send(&queue->handle);
+  assert(err == 0);
+}
+
+static AVBufferRef *
+bare_ffmpeg__pin_create(js_env_t *env, js_arraybuffer_t buffer, uint8_t *data, size_t len, int flags) {
+  int err;
+
+  auto queue = bare_ffmpeg__pin_queue_get(env);
+
+  auto pin = new bare_ffmpeg_pin_t();
+
+  pin->queue = queue;
+
+  err = js_create_reference(env, buffer, pin->buffer);
+  assert(err == 0);
+
+  auto buf = av_buffer_create(data, len, bare_ffmpeg__on_pin_free, pin, flags);
+
+  if (buf == NULL) {
+    pin->buffer.reset();
+
+    delete pin;
+  } else {
+    uv_mutex_lock(&queue->lock);
+
+    queue->pins++;
+
+    uv_mutex_unlock(&queue->lock);
+  }
+
+  return buf;
+}
+
+static void
+bare_ffmpeg__on_buffer_view_finalize(js_env_t *env, void *data, void *finalize_hint) {
+  auto buf = static_cast<AVBufferRef *>(finalize_hint);
+
+  av_buffer_unref(&buf);
+}
+
 static int
 bare_ffmpeg__on_io_context_write(void *opaque, const uint8_t *buf, int len) {
   int err;
@@ -194,6 +709,72 @@ bare_ffmpeg__on_io_context_write(void *opaque, const uint8_t *buf, int len) {
   return 0;
 }
 
+static int
+bare_ffmpeg__io_context_flush_chunk(bare_ffmpeg_io_context_t *context) {
+  int err;
+
+  if (context->write_length == 0) return 0;
+
+  auto env = context->env;
+
+  auto chunk = context->write_chunk;
+  auto length = context->write_length;
+
+  context->write_chunk = NULL;
+  context->write_length = 0;
+
+  bare_ffmpeg_io_context_write_cb_t callback;
+  err = js_get_reference_value(env, context->on_write, callback);
+  assert(err == 0);
+
+  // Ownership of the chunk moves to the view, which returns it to the pool
+  // once the ArrayBuffer is garbage collected
+  js_value_t *value;
+  err = js_create_external_arraybuffer(env, chunk->data, length, bare_ffmpeg__on_buffer_view_finalize, chunk, &value);
+  assert(err == 0);
+
+  err = js_call_function(env, callback, js_arraybuffer_t(value));
+
+  if (err < 0) return AVERROR(EIO);
+
+  return 0;
+}
+
+static int
+bare_ffmpeg__on_io_context_coalesced_write(void *opaque, const uint8_t *buf, int len) {
+  int err;
+
+  auto context = static_cast<bare_ffmpeg_io_context_t *>(opaque);
+
+  auto remaining = static_cast<size_t>(len);
+
+  while (remaining > 0) {
+    if (context->write_chunk == NULL) {
+      context->write_chunk = av_buffer_pool_get(context->write_pool);
+
+      if (context->write_chunk == NULL) return AVERROR(ENOMEM);
+    }
+
+    auto available = context->write_size - context->write_length;
+
+    auto size = remaining < available ? remaining : available;
+
+    memcpy(&context->write_chunk->data[context->write_length], buf, size);
+
+    context->write_length += size;
+
+    buf += size;
+    remaining -= size;
+
+    if (context->write_length == context->write_size) {
+      err = bare_ffmpeg__io_context_flush_chunk(context);
+      if (err < 0) return err;
+    }
+  }
+
+  return 0;
+}
+
 static int
 bare_ffmpeg__on_io_context_read(void *opaque, uint8_t *buf, int len) {
   int err;
@@ -230,9 +811,13 @@ bare_ffmpeg__on_io_context_seek(void *opaque, int64_t offset, int whence) {
   auto context = reinterpret_cast<bare_ffmpeg_io_context_t *>(opaque);
   auto env = context->env;
 
+  // Coalesced data belongs before the seek target, so hand it over first
+  int err = bare_ffmpeg__io_context_flush_chunk(context);
+  if (err < 0) return err;
+
   int64_t result;
   bare_ffmpeg_io_context_seek_cb_t callback;
-  int err = js_get_reference_value(env, context->on_seek, callback);
+  err = js_get_reference_value(env, context->on_seek, callback);
   assert(err == 0);
 
   err = js_call_function<
@@ -251,16 +836,262 @@ bare_ffmpeg__on_io_context_seek(void *opaque, int64_t offset, int whence) {
   return result;
 }
 
-static js_arraybuffer_t
-bare_ffmpeg_io_context_init(
-  js_env_t *env,
-  js_receiver_t,
-  std::optional<js_arraybuffer_span_t> data,
+static int64_t
+bare_ffmpeg__io_context_seek_to(bare_ffmpeg_io_context_t *context, int64_t offset, int whence) {
+  int64_t position;
+
+  switch (whence & ~AVSEEK_FORCE) {
+  case AVSEEK_SIZE:
+    return context->size;
+  case SEEK_SET:
+    position = offset;
+    break;
+  case SEEK_CUR:
+    position = context->position + offset;
+    break;
+  case SEEK_END:
+    position = context->size + offset;
+    break;
+  default:
+    return AVERROR(EINVAL);
+  }
+
+  if (position < 0) return AVERROR(EINVAL);
+
+  context->position = position;
+
+  return position;
+}
+
+static int
+bare_ffmpeg__on_io_context_file_read(void *opaque, uint8_t *buf, int len) {
+  auto context = static_cast<bare_ffmpeg_io_context_t *>(opaque);
+
+  uv_fs_t req;
+  uv_buf_t data = uv_buf_init(reinterpret_cast<char *>(buf), static_cast<unsigned int>(len));
+
+  // Files that cannot be seeked are read from their current offset
+  auto offset = context->size < 0 ? -1 : context->position;
+
+  int result = uv_fs_read(NULL, &req, context->fd, &data, 1, offset, NULL);
+
+  uv_fs_req_cleanup(&req);
+
+  if (result < 0) return AVERROR(EIO);
+
+  if (result == 0) return AVERROR_EOF;
+
+  context->position += result;
+
+  return result;
+}
+
+static int
+bare_ffmpeg__on_io_context_memory_read(void *opaque, uint8_t *buf, int len) {
+  auto context = static_cast<bare_ffmpeg_io_context_t *>(opaque);
+
+  if (context->position >= context->size) return AVERROR_EOF;
+
+  auto remaining = context->size - context->position;
+
+  int result = remaining < len ? static_cast<int>(remaining) : len;
+
+  memcpy(buf, &context->data[context->position], static_cast<size_t>(result));
+
+  context->position += result;
+
+  return result;
+}
+
+// The caller's buffer is read in place, so make sure it still backs the
+// source before handing the context to FFmpeg. A detached ArrayBuffer reports
+// no memory at all.
+static void
+bare_ffmpeg__io_context_check_source(js_env_t *env, AVIOContext *io) {
+  int err;
+
+  if (io == NULL || io->read_packet != bare_ffmpeg__on_io_context_memory_read) return;
+
+  auto context = static_cast<bare_ffmpeg_io_context_t *>(io->opaque);
+
+  js_arraybuffer_t buffer;
+  err = js_get_reference_value(env, context->source, buffer);
+  assert(err == 0);
+
+  std::span<uint8_t> view;
+  err = js_get_arraybuffer_info(env, buffer, view);
+  assert(err == 0);
+
+  auto start = view.data();
+  auto end = start + view.size();
+
+  if (start == NULL || context->data < start || context->data + context->size > end) {
+    err = js_throw_error(env, NULL, "IOContext buffer has been detached");
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+}
+
+static int64_t
+bare_ffmpeg__on_io_context_source_seek(void *opaque, int64_t offset, int whence) {
+  auto context = static_cast<bare_ffmpeg_io_context_t *>(opaque);
+
+  return bare_ffmpeg__io_context_seek_to(context, offset, whence);
+}
+
+static int
+bare_ffmpeg__on_interrupt(void *opaque) {
+  auto interrupt = static_cast<bare_ffmpeg_interrupt_t *>(opaque);
+
+  if (interrupt->aborted) return 1;
+
+  uint64_t deadline = interrupt->deadline;
+
+  return deadline != 0 && uv_hrtime() >= deadline;
+}
+
+static void
+bare_ffmpeg__interrupt_arm(bare_ffmpeg_interrupt_t *interrupt) {
+  interrupt->deadline = interrupt->timeout == 0 ? 0 : uv_hrtime() + interrupt->timeout;
+}
+
+static void
+bare_ffmpeg__interrupt_disarm(bare_ffmpeg_interrupt_t *interrupt) {
+  interrupt->deadline = 0;
+}
+
+static int
+bare_ffmpeg__on_io_context_stream_read(void *opaque, uint8_t *buf, int len) {
+  auto context = static_cast<bare_ffmpeg_io_context_t *>(opaque);
+
+  auto stream = context->stream;
+
+  auto self = uv_thread_self();
+
+  // Only wait for more data when demuxing off the loop thread, as nothing
+  // could push it while the loop thread is blocked
+  bool blocking = !uv_thread_equal(&self, &stream->loop_thread);
+
+  uv_mutex_lock(&stream->lock);
+
+  int result;
+
+  while (blocking && stream->length == 0 && !stream->ended) {
+    auto interrupt = stream->interrupt;
+
+    if (interrupt == NULL) {
+      uv_cond_wait(&stream->readable, &stream->lock);
+      continue;
+    }
+
+    // Custom I/O is never checked for interrupts by libavformat, so waiting
+    // for data is bounded by the deadline of the format context instead
+    if (bare_ffmpeg__on_interrupt(interrupt)) {
+      uv_mutex_unlock(&stream->lock);
+
+      return AVERROR_EXIT;
+    }
+
+    uint64_t deadline = interrupt->deadline;
+
+    if (deadline == 0) {
+      uv_cond_wait(&stream->readable, &stream->lock);
+    } else {
+      uint64_t now = uv_hrtime();
+
+      if (deadline > now) uv_cond_timedwait(&stream->readable, &stream->lock, deadline - now);
+    }
+  }
+
+  if (stream->length == 0) {
+    result = stream->ended ? AVERROR_EOF : AVERROR(EAGAIN);
+  } else {
+    auto size = stream->length < static_cast<size_t>(len) ? stream->length : static_cast<size_t>(len);
+
+    auto head = stream->capacity - stream->start;
+
+    if (size <= head) {
+      memcpy(buf, &stream->data[stream->start], size);
+    } else {
+      memcpy(buf, &stream->data[stream->start], head);
+      memcpy(&buf[head], stream->data, size - head);
+    }
+
+    stream->start = (stream->start + size) % stream->capacity;
+    stream->length -= size;
+
+    if (stream->needs_drain && stream->length < stream->high_water_mark) {
+      stream->needs_drain = false;
+
+      uv_async_send(&stream->drain);
+    }
+
+    result = static_cast<int>(size);
+  }
+
+  uv_mutex_unlock(&stream->lock);
+
+  return result;
+}
+
+static void
+bare_ffmpeg__on_io_stream_drain(uv_async_t *handle) {
+  int err;
+
+  auto stream = reinterpret_cast<bare_ffmpeg_io_stream_t *>(handle);
+
+  auto env = stream->env;
+
+  js_handle_scope_t *scope;
+  err = js_open_handle_scope(env, &scope);
+  assert(err == 0);
+
+  bare_ffmpeg_io_context_drain_cb_t callback;
+  err = js_get_reference_value(env, stream->on_drain, callback);
+  assert(err == 0);
+
+  err = js_call_function(env, callback);
+
+  // There is no caller to propagate an exception thrown by the callback to,
+  // so report it as uncaught
+  if (err < 0) {
+    bool pending;
+    err = js_is_exception_pending(env, &pending);
+    assert(err == 0);
+
+    if (pending) {
+      js_value_t *error;
+      err = js_get_and_clear_last_exception(env, &error);
+      assert(err == 0);
+
+      err = js_fatal_exception(env, error);
+      assert(err == 0);
+    }
+  }
+
+  err = js_close_handle_scope(env, scope);
+  assert(err == 0);
+}
+
+static void
+bare_ffmpeg__on_io_stream_close(uv_handle_t *handle) {
+  auto stream = reinterpret_cast<bare_ffmpeg_io_stream_t *>(handle);
+
+  delete stream;
+}
+
+static js_arraybuffer_t
+bare_ffmpeg_io_context_init(
+  js_env_t *env,
+  js_receiver_t,
+  std::optional<js_arraybuffer_span_t> data,
   uint64_t offset,
   uint64_t len,
   std::optional<bare_ffmpeg_io_context_write_cb_t> on_write,
   std::optional<bare_ffmpeg_io_context_read_cb_t> on_read,
-  std::optional<bare_ffmpeg_io_context_seek_cb_t> on_seek
+  std::optional<bare_ffmpeg_io_context_seek_cb_t> on_seek,
+  uint32_t write_size
 ) {
   int err;
 
@@ -271,6 +1102,16 @@ bare_ffmpeg_io_context_init(
   assert(err == 0);
 
   context->env = env;
+  context->fd = -1;
+
+  auto write_packet = on_write ? bare_ffmpeg__on_io_context_write : nullptr;
+
+  if (on_write && write_size > 0) {
+    context->write_pool = av_buffer_pool_init(write_size, NULL);
+    context->write_size = write_size;
+
+    write_packet = bare_ffmpeg__on_io_context_coalesced_write;
+  }
 
   int writable = 0;
 
@@ -305,7 +1146,7 @@ bare_ffmpeg_io_context_init(
     writable,
     context,
     on_read ? bare_ffmpeg__on_io_context_read : nullptr,
-    on_write ? bare_ffmpeg__on_io_context_write : nullptr,
+    write_packet,
     on_seek ? bare_ffmpeg__on_io_context_seek : nullptr
   );
 
@@ -316,62 +1157,52 @@ bare_ffmpeg_io_context_init(
   return handle;
 }
 
-static void
-bare_ffmpeg_io_context_destroy(
+static js_arraybuffer_t
+bare_ffmpeg_io_context_init_from_file(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_io_context_t, 1> context
+  std::optional<std::string> path,
+  int32_t fd,
+  uint32_t buffer_size
 ) {
-  av_free(context->handle->buffer);
-
-  avio_context_free(&context->handle);
+  int err;
 
-  context->on_write.reset();
-  context->on_read.reset();
-  context->on_seek.reset();
-}
+  uv_fs_t req;
 
-static js_arraybuffer_t
-bare_ffmpeg_output_format_init(js_env_t *env, js_receiver_t, std::string name) {
-  int err;
+  bool owns_fd = false;
 
-  const AVOutputFormat *format = av_guess_format(name.c_str(), NULL, NULL);
+  if (path) {
+    err = uv_fs_open(NULL, &req, path->c_str(), UV_FS_O_RDONLY, 0, NULL);
 
-  if (format == NULL) {
-    err = js_throw_errorf(env, NULL, "No output format found for name '%s'", name.c_str());
-    assert(err == 0);
+    uv_fs_req_cleanup(&req);
 
-    throw js_pending_exception;
-  }
+    if (err < 0) {
+      err = js_throw_error(env, uv_err_name(err), uv_strerror(err));
+      assert(err == 0);
 
-  js_arraybuffer_t handle;
+      throw js_pending_exception;
+    }
 
-  bare_ffmpeg_output_format_t *context;
-  err = js_create_arraybuffer(env, context, handle);
-  assert(err == 0);
+    fd = err;
+    owns_fd = true;
+  }
 
-  context->handle = format;
+  err = uv_fs_fstat(NULL, &req, fd, NULL);
 
-  return handle;
-}
+  // Pipes, sockets and character devices can only be read sequentially
+  bool seekable = (req.statbuf.st_mode & S_IFMT) == S_IFREG;
 
-static int32_t
-bare_ffmpeg_output_format_get_flags(
-  js_env_t *,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_output_format_t, 1> format
-) {
-  return format->handle->flags;
-}
+  auto size = seekable ? static_cast<int64_t>(req.statbuf.st_size) : -1;
 
-static js_arraybuffer_t
-bare_ffmpeg_input_format_init(js_env_t *env, js_receiver_t, std::string name) {
-  int err;
+  uv_fs_req_cleanup(&req);
 
-  const AVInputFormat *format = av_find_input_format(name.c_str());
+  if (err < 0) {
+    if (owns_fd) {
+      uv_fs_close(NULL, &req, fd, NULL);
+      uv_fs_req_cleanup(&req);
+    }
 
-  if (format == NULL) {
-    err = js_throw_errorf(env, NULL, "No input format found for name '%s'", name.c_str());
+    err = js_throw_error(env, uv_err_name(err), uv_strerror(err));
     assert(err == 0);
 
     throw js_pending_exception;
@@ -379,101 +1210,104 @@ bare_ffmpeg_input_format_init(js_env_t *env, js_receiver_t, std::string name) {
 
   js_arraybuffer_t handle;
 
-  bare_ffmpeg_input_format_t *context;
+  bare_ffmpeg_io_context_t *context;
   err = js_create_arraybuffer(env, context, handle);
   assert(err == 0);
 
-  context->handle = format;
+  context->env = env;
+  context->fd = fd;
+  context->owns_fd = owns_fd;
+  context->size = size;
+  context->position = 0;
+
+  auto io = reinterpret_cast<uint8_t *>(av_malloc(buffer_size));
+
+  if (io) {
+    context->handle = avio_alloc_context(
+      io,
+      static_cast<int>(buffer_size),
+      0,
+      context,
+      bare_ffmpeg__on_io_context_file_read,
+      nullptr,
+      seekable ? bare_ffmpeg__on_io_context_source_seek : nullptr
+    );
 
-  return handle;
-}
+    if (context->handle == NULL) av_free(io);
+  }
 
-static int32_t
-bare_ffmpeg_input_format_get_flags(
-  js_env_t *,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_input_format_t, 1> format
-) {
-  return format->handle->flags;
-}
+  if (context->handle == NULL) {
+    if (owns_fd) {
+      uv_fs_close(NULL, &req, fd, NULL);
+      uv_fs_req_cleanup(&req);
+    }
 
-static std::string
-bare_ffmpeg_input_format_get_extensions(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_input_format_t, 1> context
-) {
-  return context->handle->extensions;
-}
+    context->fd = -1;
 
-static std::string
-bare_ffmpeg_input_format_get_mime_type(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_input_format_t, 1> context
-) {
-  return context->handle->mime_type;
-}
+    err = js_throw_error(env, NULL, av_err2str(AVERROR(ENOMEM)));
+    assert(err == 0);
 
-static std::string
-bare_ffmpeg_input_format_get_name(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_input_format_t, 1> context
-) {
-  return context->handle->name;
+    throw js_pending_exception;
+  }
+
+  return handle;
 }
 
 static js_arraybuffer_t
-bare_ffmpeg_format_context_open_input_with_io(
+bare_ffmpeg_io_context_init_from_buffer(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_io_context_t, 1> io
+  js_arraybuffer_t buffer,
+  uint64_t offset,
+  uint64_t len,
+  uint32_t buffer_size
 ) {
   int err;
 
+  std::span<uint8_t> view;
+  err = js_get_arraybuffer_info(env, buffer, view);
+  assert(err == 0);
+
+  assert(offset + len <= view.size());
+
   js_arraybuffer_t handle;
 
-  bare_ffmpeg_format_context_t *context;
+  bare_ffmpeg_io_context_t *context;
   err = js_create_arraybuffer(env, context, handle);
   assert(err == 0);
 
-  context->handle = avformat_alloc_context();
-  context->handle->pb = io->handle;
-  context->handle->opaque = (void *) context;
+  context->env = env;
+  context->fd = -1;
 
-  err = avformat_open_input(&context->handle, NULL, NULL, NULL);
-  if (err < 0) {
-    avformat_free_context(context->handle);
+  // Keep the caller's buffer alive and read from it in place rather than
+  // copying it into the AVIO buffer.
+  err = js_create_reference(env, buffer, context->source);
+  assert(err == 0);
 
-    bool is_exception_pending;
-    err = js_is_exception_pending(env, &is_exception_pending);
-    assert(err == 0);
-
-    if (is_exception_pending) throw js_pending_exception;
-
-    err = js_throw_error(env, NULL, av_err2str(err));
-    assert(err == 0);
-
-    throw js_pending_exception;
-  }
-
-  err = avformat_find_stream_info(context->handle, NULL);
-
-  bool is_exception_pending;
-  int check = js_is_exception_pending(env, &is_exception_pending);
-  assert(check == 0);
-
-  if (is_exception_pending) {
-    avformat_close_input(&context->handle);
+  context->data = view.data() + offset;
+  context->size = static_cast<int64_t>(len);
+  context->position = 0;
+
+  auto io = reinterpret_cast<uint8_t *>(av_malloc(buffer_size));
+
+  if (io) {
+    context->handle = avio_alloc_context(
+      io,
+      static_cast<int>(buffer_size),
+      0,
+      context,
+      bare_ffmpeg__on_io_context_memory_read,
+      nullptr,
+      bare_ffmpeg__on_io_context_source_seek
+    );
 
-    throw js_pending_exception;
+    if (context->handle == NULL) av_free(io);
   }
 
-  if (err < 0) {
-    avformat_close_input(&context->handle);
+  if (context->handle == NULL) {
+    context->source.reset();
 
-    err = js_throw_error(env, NULL, av_err2str(err));
+    err = js_throw_error(env, NULL, av_err2str(AVERROR(ENOMEM)));
     assert(err == 0);
 
     throw js_pending_exception;
@@ -483,280 +1317,214 @@ bare_ffmpeg_format_context_open_input_with_io(
 }
 
 static js_arraybuffer_t
-bare_ffmpeg_format_context_open_input_with_format(
+bare_ffmpeg_io_context_init_stream(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_input_format_t, 1> format,
-  js_arraybuffer_span_of_t<bare_ffmpeg_dictionary_t, 1> options,
-  std::string url
+  uint32_t buffer_size,
+  uint32_t high_water_mark,
+  bare_ffmpeg_io_context_drain_cb_t on_drain
 ) {
   int err;
 
+  uv_loop_t *loop;
+  err = js_get_env_loop(env, &loop);
+  assert(err == 0);
+
   js_arraybuffer_t handle;
 
-  bare_ffmpeg_format_context_t *context;
+  bare_ffmpeg_io_context_t *context;
   err = js_create_arraybuffer(env, context, handle);
   assert(err == 0);
 
-  context->handle = avformat_alloc_context();
-  context->handle->opaque = (void *) context;
+  context->env = env;
+  context->fd = -1;
 
-  err = avformat_open_input(&context->handle, url.c_str(), format->handle, &options->handle);
-  if (err < 0) {
-    avformat_free_context(context->handle);
+  auto stream = new bare_ffmpeg_io_stream_t();
 
-    err = js_throw_error(env, NULL, av_err2str(err));
-    assert(err == 0);
+  stream->env = env;
+  stream->loop_thread = uv_thread_self();
+  stream->capacity = high_water_mark;
+  stream->data = reinterpret_cast<uint8_t *>(av_malloc(stream->capacity));
+  stream->high_water_mark = high_water_mark;
 
-    throw js_pending_exception;
-  }
+  err = uv_mutex_init(&stream->lock);
+  assert(err == 0);
 
-  err = avformat_find_stream_info(context->handle, NULL);
+  err = uv_cond_init(&stream->readable);
+  assert(err == 0);
 
-  bool is_exception_pending;
-  int check = js_is_exception_pending(env, &is_exception_pending);
-  assert(check == 0);
+  err = uv_async_init(loop, &stream->drain, bare_ffmpeg__on_io_stream_drain);
+  assert(err == 0);
 
-  if (is_exception_pending) {
-    avformat_close_input(&context->handle);
+  uv_unref(reinterpret_cast<uv_handle_t *>(&stream->drain));
 
-    throw js_pending_exception;
-  }
+  err = js_create_reference(env, on_drain, stream->on_drain);
+  assert(err == 0);
 
-  if (err < 0) {
-    avformat_close_input(&context->handle);
+  context->stream = stream;
 
-    err = js_throw_error(env, NULL, av_err2str(err));
-    assert(err == 0);
+  auto io = reinterpret_cast<uint8_t *>(av_malloc(buffer_size));
 
-    throw js_pending_exception;
-  }
+  context->handle = avio_alloc_context(
+    io,
+    static_cast<int>(buffer_size),
+    0,
+    context,
+    bare_ffmpeg__on_io_context_stream_read,
+    nullptr,
+    nullptr
+  );
 
-  return handle;
-}
+  context->handle->seekable = 0;
 
-static void
-bare_ffmpeg_format_context_close_input(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_format_context_t, 1> context
-) {
-  avformat_close_input(&context->handle);
+  return handle;
 }
 
-static js_arraybuffer_t
-bare_ffmpeg_format_context_open_output(
+static bool
+bare_ffmpeg_io_context_push(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_output_format_t, 1> format,
-  js_arraybuffer_span_of_t<bare_ffmpeg_io_context_t, 1> io
+  js_arraybuffer_span_of_t<bare_ffmpeg_io_context_t, 1> context,
+  js_arraybuffer_span_t data,
+  uint64_t offset,
+  uint64_t len
 ) {
   int err;
 
-  js_arraybuffer_t handle;
-
-  bare_ffmpeg_format_context_t *context;
-  err = js_create_arraybuffer(env, context, handle);
-  assert(err == 0);
+  auto stream = context->stream;
 
-  err = avformat_alloc_output_context2(&context->handle, format->handle, NULL, NULL);
-  if (err < 0) {
-    err = js_throw_error(env, NULL, av_err2str(err));
+  if (stream == NULL) {
+    err = js_throw_error(env, NULL, "IOContext has been destroyed");
     assert(err == 0);
 
     throw js_pending_exception;
   }
 
-  context->handle->pb = io->handle;
-  context->handle->opaque = (void *) context;
-
-  return handle;
-}
+  auto size = static_cast<size_t>(len);
 
-static std::string
-bare_ffmpeg_output_format_get_extensions(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_output_format_t, 1> context
-) {
-  return context->handle->extensions;
-}
+  uv_mutex_lock(&stream->lock);
 
-static std::string
-bare_ffmpeg_output_format_get_mime_type(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_output_format_t, 1> context
-) {
-  return context->handle->mime_type;
-}
+  if (stream->ended) {
+    uv_mutex_unlock(&stream->lock);
 
-static std::string
-bare_ffmpeg_output_format_get_name(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_output_format_t, 1> context
-) {
-  return context->handle->name;
-}
+    err = js_throw_error(env, NULL, "Cannot push data after the end of the stream");
+    assert(err == 0);
 
-static void
-bare_ffmpeg_format_context_close_output(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_format_context_t, 1> context
-) {
-  avformat_free_context(context->handle);
-}
+    throw js_pending_exception;
+  }
 
-static js_array_t
-bare_ffmpeg_format_context_get_streams(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_format_context_t, 1> context
-) {
-  int err;
+  // The ring grows rather than rejecting data, the return value signals
+  // when the caller should stop pushing until the drain callback fires
+  if (stream->length + size > stream->capacity) {
+    auto capacity = stream->capacity * 2;
 
-  auto len = context->handle->nb_streams;
+    if (capacity < stream->length + size) capacity = stream->length + size;
 
-  js_array_t result;
-  err = js_create_array(env, len, result);
-  assert(err == 0);
+    auto grown = reinterpret_cast<uint8_t *>(av_malloc(capacity));
 
-  for (uint32_t i = 0; i < len; i++) {
-    js_arraybuffer_t handle;
+    auto head = stream->capacity - stream->start;
 
-    bare_ffmpeg_stream_t *stream;
-    err = js_create_arraybuffer(env, stream, handle);
-    assert(err == 0);
+    if (stream->length <= head) {
+      memcpy(grown, &stream->data[stream->start], stream->length);
+    } else {
+      memcpy(grown, &stream->data[stream->start], head);
+      memcpy(&grown[head], stream->data, stream->length - head);
+    }
 
-    stream->handle = context->handle->streams[i];
+    av_free(stream->data);
 
-    err = js_set_element(env, result, i, handle);
-    assert(err == 0);
+    stream->data = grown;
+    stream->capacity = capacity;
+    stream->start = 0;
   }
 
-  return result;
-}
+  auto source = &data[static_cast<size_t>(offset)];
 
-static int64_t
-bare_ffmpeg_format_context_get_duration(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_format_context_t, 1> context
-) {
-  if (context->handle->duration == AV_NOPTS_VALUE) return -1;
+  auto end = (stream->start + stream->length) % stream->capacity;
 
-  return context->handle->duration;
-}
+  auto tail = stream->capacity - end;
 
-static int
-bare_ffmpeg_format_context_get_best_stream_index(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_format_context_t, 1> context,
-  int32_t type
-) {
-  auto i = av_find_best_stream(context->handle, static_cast<AVMediaType>(type), -1, -1, NULL, 0);
+  if (size <= tail) {
+    memcpy(&stream->data[end], source, size);
+  } else {
+    memcpy(&stream->data[end], source, tail);
+    memcpy(stream->data, &source[tail], size - tail);
+  }
 
-  if (i < 0) i = -1;
+  stream->length += size;
 
-  return i;
-}
+  bool below_high_water_mark = stream->length < stream->high_water_mark;
 
-static js_arraybuffer_t
-bare_ffmpeg_format_context_create_stream(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_format_context_t, 1> context
-) {
-  int err;
+  if (!below_high_water_mark) stream->needs_drain = true;
 
-  js_arraybuffer_t handle;
+  uv_cond_signal(&stream->readable);
 
-  bare_ffmpeg_stream_t *stream;
-  err = js_create_arraybuffer(env, stream, handle);
-  assert(err == 0);
+  uv_mutex_unlock(&stream->lock);
 
-  stream->handle = avformat_new_stream(context->handle, NULL);
-  return handle;
+  return below_high_water_mark;
 }
 
-static bool
-bare_ffmpeg_format_context_read_frame(
+static void
+bare_ffmpeg_io_context_end(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_format_context_t, 1> context,
-  js_arraybuffer_span_of_t<bare_ffmpeg_packet_t, 1> packet
+  js_arraybuffer_span_of_t<bare_ffmpeg_io_context_t, 1> context
 ) {
-  int err;
+  auto stream = context->stream;
 
-  av_packet_unref(packet->handle);
+  if (stream == NULL) return;
 
-  err = av_read_frame(context->handle, packet->handle);
-  if (err < 0 && err != AVERROR(EAGAIN) && err != AVERROR_EOF) {
-    err = js_throw_error(env, NULL, av_err2str(err));
-    assert(err == 0);
+  uv_mutex_lock(&stream->lock);
 
-    throw js_pending_exception;
-  }
+  stream->ended = true;
 
-  return err == 0;
+  uv_cond_signal(&stream->readable);
+
+  uv_mutex_unlock(&stream->lock);
 }
 
-static bool
-bare_ffmpeg_format_context_write_header(
+static uint32_t
+bare_ffmpeg_io_context_get_buffered(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_format_context_t, 1> context,
-  std::optional<js_arraybuffer_span_of_t<bare_ffmpeg_dictionary_t, 1>> options
+  js_arraybuffer_span_of_t<bare_ffmpeg_io_context_t, 1> context
 ) {
-  int err;
+  auto stream = context->stream;
 
-  if (options) {
-    err = avformat_write_header(context->handle, &options.value()->handle);
-  } else {
-    err = avformat_write_header(context->handle, NULL);
-  }
+  if (stream == NULL) return 0;
 
-  if (err < 0) {
-    err = js_throw_error(env, NULL, av_err2str(err));
-    assert(err == 0);
+  uv_mutex_lock(&stream->lock);
 
-    throw js_pending_exception;
-  }
+  auto length = stream->length;
 
-  return err;
+  uv_mutex_unlock(&stream->lock);
+
+  return static_cast<uint32_t>(length);
 }
 
 static void
-bare_ffmpeg_format_context_write_frame(
+bare_ffmpeg_io_context_flush(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_format_context_t, 1> context,
-  js_arraybuffer_span_of_t<bare_ffmpeg_packet_t, 1> packet
+  js_arraybuffer_span_of_t<bare_ffmpeg_io_context_t, 1> context
 ) {
   int err;
 
-  err = av_interleaved_write_frame(context->handle, packet->handle);
-  if (err < 0) {
-    err = js_throw_error(env, NULL, av_err2str(err));
-    assert(err == 0);
+  if (context->handle == NULL || !context->handle->write_flag) return;
 
-    throw js_pending_exception;
-  }
-}
+  avio_flush(context->handle);
 
-static void
-bare_ffmpeg_format_context_write_trailer(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_format_context_t, 1> context
-) {
-  int err;
+  err = context->handle->error;
+
+  if (err >= 0) err = bare_ffmpeg__io_context_flush_chunk(context);
 
-  err = av_write_trailer(context->handle);
   if (err < 0) {
+    bool is_exception_pending;
+    err = js_is_exception_pending(env, &is_exception_pending);
+    assert(err == 0);
+
+    if (is_exception_pending) throw js_pending_exception;
+
     err = js_throw_error(env, NULL, av_err2str(err));
     assert(err == 0);
 
@@ -765,416 +1533,345 @@ bare_ffmpeg_format_context_write_trailer(
 }
 
 static void
-bare_ffmpeg_format_context_dump(
+bare_ffmpeg_io_context_destroy(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_format_context_t, 1> context,
-  bool is_output,
-  int32_t index,
-  std::string url
+  js_arraybuffer_span_of_t<bare_ffmpeg_io_context_t, 1> context
 ) {
-  av_dump_format(context->handle, index, url.c_str(), is_output);
+  av_free(context->handle->buffer);
 
-  for (int i = 0; i < context->handle->nb_streams; i++) {
-    auto stream = context->handle->streams[i];
+  avio_context_free(&context->handle);
 
-    av_log(NULL, AV_LOG_INFO, "  - stream=%i timebase=(%i / %i)\n", i, stream->time_base.num, stream->time_base.den);
+  context->on_write.reset();
+  context->on_read.reset();
+  context->on_seek.reset();
+
+  if (context->owns_fd) {
+    uv_fs_t req;
+    uv_fs_close(NULL, &req, context->fd, NULL);
+    uv_fs_req_cleanup(&req);
+
+    context->owns_fd = false;
+  }
+
+  context->fd = -1;
+
+  context->source.reset();
+  context->data = NULL;
+
+  // Chunks still held by JavaScript keep the pool alive until they are
+  // garbage collected
+  av_buffer_unref(&context->write_chunk);
+  av_buffer_pool_uninit(&context->write_pool);
+
+  context->write_length = 0;
+
+  if (context->stream) {
+    auto stream = context->stream;
+
+    stream->on_drain.reset();
+
+    // Format contexts cannot be destroyed while an operation is pending, so
+    // no worker is waiting on the stream at this point
+    uv_mutex_destroy(&stream->lock);
+    uv_cond_destroy(&stream->readable);
+
+    av_free(stream->data);
+
+    uv_close(reinterpret_cast<uv_handle_t *>(&stream->drain), bare_ffmpeg__on_io_stream_close);
+
+    context->stream = NULL;
   }
 }
 
-static std::optional<js_arraybuffer_t>
-get_bare_ffmpeg_format_context_output_format(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_format_context_t, 1> context
-) {
+static js_arraybuffer_t
+bare_ffmpeg_output_format_init(js_env_t *env, js_receiver_t, std::string name) {
   int err;
 
-  if (!context->handle->oformat) return std::nullopt;
+  const AVOutputFormat *format = av_guess_format(name.c_str(), NULL, NULL);
+
+  if (format == NULL) {
+    err = js_throw_errorf(env, NULL, "No output format found for name '%s'", name.c_str());
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
 
   js_arraybuffer_t handle;
 
-  bare_ffmpeg_output_format_t *format;
-  err = js_create_arraybuffer(env, format, handle);
+  bare_ffmpeg_output_format_t *context;
+  err = js_create_arraybuffer(env, context, handle);
   assert(err == 0);
 
-  format->handle = context->handle->oformat;
+  context->handle = format;
 
   return handle;
 }
 
-static std::optional<js_arraybuffer_t>
-get_bare_ffmpeg_format_context_input_format(
-  js_env_t *env,
+static int32_t
+bare_ffmpeg_output_format_get_flags(
+  js_env_t *,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_format_context_t, 1> context
+  js_arraybuffer_span_of_t<bare_ffmpeg_output_format_t, 1> format
 ) {
+  return format->handle->flags;
+}
+
+static js_arraybuffer_t
+bare_ffmpeg_input_format_init(js_env_t *env, js_receiver_t, std::string name) {
   int err;
 
-  if (!context->handle->iformat) return std::nullopt;
+  const AVInputFormat *format = av_find_input_format(name.c_str());
+
+  if (format == NULL) {
+    err = js_throw_errorf(env, NULL, "No input format found for name '%s'", name.c_str());
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
 
   js_arraybuffer_t handle;
 
-  bare_ffmpeg_input_format_t *format;
-  err = js_create_arraybuffer(env, format, handle);
+  bare_ffmpeg_input_format_t *context;
+  err = js_create_arraybuffer(env, context, handle);
   assert(err == 0);
 
-  format->handle = context->handle->iformat;
+  context->handle = format;
 
   return handle;
 }
 
 static int32_t
-bare_ffmpeg_stream_get_index(
-  js_env_t *env,
+bare_ffmpeg_input_format_get_flags(
+  js_env_t *,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_stream_t, 1> stream
+  js_arraybuffer_span_of_t<bare_ffmpeg_input_format_t, 1> format
 ) {
-  return stream->handle->index;
+  return format->handle->flags;
 }
 
-static int32_t
-bare_ffmpeg_stream_get_id(
+static std::string
+bare_ffmpeg_input_format_get_extensions(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_stream_t, 1> stream
+  js_arraybuffer_span_of_t<bare_ffmpeg_input_format_t, 1> context
 ) {
-  return stream->handle->id;
+  return context->handle->extensions;
 }
 
-static void
-bare_ffmpeg_stream_set_id(
+static std::string
+bare_ffmpeg_input_format_get_mime_type(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_stream_t, 1> stream,
-  int32_t id
+  js_arraybuffer_span_of_t<bare_ffmpeg_input_format_t, 1> context
 ) {
-  stream->handle->id = id;
+  return context->handle->mime_type;
 }
 
-static js_arraybuffer_t
-bare_ffmpeg_stream_get_time_base(
+static std::string
+bare_ffmpeg_input_format_get_name(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_stream_t, 1> stream
+  js_arraybuffer_span_of_t<bare_ffmpeg_input_format_t, 1> context
 ) {
-  int err;
+  return context->handle->name;
+}
 
-  js_arraybuffer_t result;
+static void
+bare_ffmpeg__format_context_init_interrupt(bare_ffmpeg_format_context_t *context, uint32_t timeout) {
+  context->interrupt.timeout = static_cast<uint64_t>(timeout) * 1000000;
 
-  int32_t *data;
-  err = js_create_arraybuffer(env, 2, data, result);
-  assert(err == 0);
+  context->handle->interrupt_callback.callback = bare_ffmpeg__on_interrupt;
+  context->handle->interrupt_callback.opaque = &context->interrupt;
 
-  data[0] = stream->handle->time_base.num;
-  data[1] = stream->handle->time_base.den;
+  auto io = context->handle->pb;
 
-  return result;
+  if (io && io->read_packet == bare_ffmpeg__on_io_context_stream_read) {
+    static_cast<bare_ffmpeg_io_context_t *>(io->opaque)->stream->interrupt = &context->interrupt;
+  }
 }
 
 static void
-bare_ffmpeg_stream_set_time_base(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_stream_t, 1> stream,
-  int num,
-  int den
+bare_ffmpeg__format_context_init_probe(
+  bare_ffmpeg_format_context_t *context,
+  int64_t probesize,
+  int64_t analyzeduration,
+  int32_t fpsprobesize
 ) {
-  stream->handle->time_base.num = num;
-  stream->handle->time_base.den = den;
+  // Negative values keep the FFmpeg defaults
+  if (probesize >= 0) context->handle->probesize = probesize;
+  if (analyzeduration >= 0) context->handle->max_analyze_duration = analyzeduration;
+  if (fpsprobesize >= 0) context->handle->fps_probe_size = fpsprobesize;
 }
 
-static js_arraybuffer_t
-bare_ffmpeg_stream_get_avg_framerate(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_stream_t, 1> stream
-) {
+static void
+bare_ffmpeg__format_context_throw(js_env_t *env, bare_ffmpeg_format_context_t *context, int status) {
   int err;
 
-  js_arraybuffer_t result;
+  if (status == AVERROR_EXIT) {
+    if (context->interrupt.aborted) {
+      err = js_throw_error(env, "ABORTED", "Operation was aborted");
+    } else {
+      err = js_throw_error(env, "TIMEOUT", "Operation timed out");
+    }
+  } else {
+    err = js_throw_error(env, NULL, av_err2str(status));
+  }
 
-  int32_t *data;
-  err = js_create_arraybuffer(env, 2, data, result);
   assert(err == 0);
 
-  data[0] = stream->handle->avg_frame_rate.num;
-  data[1] = stream->handle->avg_frame_rate.den;
-
-  return result;
-}
-
-static void
-bare_ffmpeg_stream_set_avg_framerate(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_stream_t, 1> stream,
-  int num,
-  int den
-) {
-  stream->handle->avg_frame_rate.num = num;
-  stream->handle->avg_frame_rate.den = den;
+  throw js_pending_exception;
 }
 
 static js_arraybuffer_t
-bare_ffmpeg_stream_get_codec_parameters(
+bare_ffmpeg_format_context_open_input_with_io(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_stream_t, 1> stream
+  js_arraybuffer_span_of_t<bare_ffmpeg_io_context_t, 1> io,
+  uint32_t timeout,
+  int64_t probesize,
+  int64_t analyzeduration,
+  int32_t fpsprobesize,
+  bool find_stream_info
 ) {
   int err;
 
+  bare_ffmpeg__io_context_check_source(env, io->handle);
+
   js_arraybuffer_t handle;
 
-  bare_ffmpeg_codec_parameters_t *parameters;
-  err = js_create_arraybuffer(env, parameters, handle);
+  bare_ffmpeg_format_context_t *context;
+  err = js_create_arraybuffer(env, context, handle);
   assert(err == 0);
 
-  parameters->handle = stream->handle->codecpar;
-
-  return handle;
-}
-
-static int64_t
-bare_ffmpeg_stream_get_duration(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_stream_t, 1> stream
-) {
-  if (stream->handle->duration == AV_NOPTS_VALUE) {
-    return 0;
-  }
-
-  return stream->handle->duration;
-}
+  context->handle = avformat_alloc_context();
+  context->handle->pb = io->handle;
+  context->handle->opaque = (void *) context;
 
-static std::vector<js_arraybuffer_t>
-bare_ffmpeg_stream_get_side_data(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_stream_t, 1> stream
-) {
-  std::vector<js_arraybuffer_t> res{};
+  bare_ffmpeg__format_context_init_interrupt(context, timeout);
+  bare_ffmpeg__format_context_init_probe(context, probesize, analyzeduration, fpsprobesize);
+  bare_ffmpeg__interrupt_arm(&context->interrupt);
 
-  AVCodecParameters *codecpar = stream->handle->codecpar;
-  int count = codecpar->nb_coded_side_data;
-  if (count == 0) return res;
+  int status = avformat_open_input(&context->handle, NULL, NULL, NULL);
+  if (status < 0) {
+    avformat_free_context(context->handle);
 
-  for (int i = 0; i < count; i++) {
-    js_arraybuffer_t handle;
-    bare_ffmpeg_side_data_t *sd;
-    int err = js_create_arraybuffer(env, sd, handle);
+    bool is_exception_pending;
+    err = js_is_exception_pending(env, &is_exception_pending);
     assert(err == 0);
 
-    sd->handle = &codecpar->coded_side_data[i];
+    if (is_exception_pending) throw js_pending_exception;
 
-    res.push_back(handle);
+    bare_ffmpeg__format_context_throw(env, context, status);
   }
 
-  return res;
-}
-
-static void
-bare_ffmpeg_stream_set_duration(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_stream_t, 1> stream,
-  int64_t duration
-) {
-  stream->handle->duration = duration;
-}
+  // Without probing, streams only carry what the container headers describe
+  if (find_stream_info) status = avformat_find_stream_info(context->handle, NULL);
 
-static js_arraybuffer_t
-bare_ffmpeg_find_decoder_by_id(js_env_t *env, js_receiver_t, uint32_t id) {
-  int err;
+  bare_ffmpeg__interrupt_disarm(&context->interrupt);
 
-  const AVCodec *decoder = avcodec_find_decoder((enum AVCodecID) id);
+  bool is_exception_pending;
+  err = js_is_exception_pending(env, &is_exception_pending);
+  assert(err == 0);
 
-  if (decoder == NULL) {
-    err = js_throw_errorf(env, NULL, "No decoder found for codec '%d'", id);
-    assert(err == 0);
+  if (is_exception_pending) {
+    avformat_close_input(&context->handle);
 
     throw js_pending_exception;
   }
 
-  js_arraybuffer_t handle;
-
-  bare_ffmpeg_codec_t *context;
-  err = js_create_arraybuffer(env, context, handle);
-  assert(err == 0);
+  if (status < 0) {
+    avformat_close_input(&context->handle);
 
-  context->handle = decoder;
+    bare_ffmpeg__format_context_throw(env, context, status);
+  }
 
   return handle;
 }
 
 static js_arraybuffer_t
-bare_ffmpeg_find_encoder_by_id(js_env_t *env, js_receiver_t, uint32_t id) {
+bare_ffmpeg_format_context_open_input_with_format(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_input_format_t, 1> format,
+  js_arraybuffer_span_of_t<bare_ffmpeg_dictionary_t, 1> options,
+  std::string url,
+  uint32_t timeout,
+  int64_t probesize,
+  int64_t analyzeduration,
+  int32_t fpsprobesize,
+  bool find_stream_info
+) {
   int err;
 
-  const AVCodec *encoder = avcodec_find_encoder((enum AVCodecID) id);
-
-  if (encoder == NULL) {
-    err = js_throw_errorf(env, NULL, "No encoder found for codec '%d'", id);
-    assert(err == 0);
-
-    throw js_pending_exception;
-  }
-
   js_arraybuffer_t handle;
 
-  bare_ffmpeg_codec_t *context;
+  bare_ffmpeg_format_context_t *context;
   err = js_create_arraybuffer(env, context, handle);
   assert(err == 0);
 
-  context->handle = encoder;
+  context->handle = avformat_alloc_context();
+  context->handle->opaque = (void *) context;
 
-  return handle;
-}
+  bare_ffmpeg__format_context_init_interrupt(context, timeout);
+  bare_ffmpeg__format_context_init_probe(context, probesize, analyzeduration, fpsprobesize);
+  bare_ffmpeg__interrupt_arm(&context->interrupt);
 
-static js_arraybuffer_t
-bare_ffmpeg_find_decoder_by_name(js_env_t *env, js_receiver_t, std::string name) {
-  int err;
+  int status = avformat_open_input(&context->handle, url.c_str(), format->handle, &options->handle);
+  if (status < 0) {
+    avformat_free_context(context->handle);
 
-  const AVCodec *decoder = avcodec_find_decoder_by_name(name.c_str());
+    bare_ffmpeg__format_context_throw(env, context, status);
+  }
 
-  if (decoder == NULL) {
-    err = js_throw_errorf(env, NULL, "No decoder found with name '%s'", name.c_str());
-    assert(err == 0);
+  if (find_stream_info) status = avformat_find_stream_info(context->handle, NULL);
 
-    throw js_pending_exception;
-  }
+  bare_ffmpeg__interrupt_disarm(&context->interrupt);
 
-  js_arraybuffer_t handle;
-  bare_ffmpeg_codec_t *context;
-  err = js_create_arraybuffer(env, context, handle);
+  bool is_exception_pending;
+  err = js_is_exception_pending(env, &is_exception_pending);
   assert(err == 0);
 
-  context->handle = decoder;
-
-  return handle;
-}
-
-static js_arraybuffer_t
-bare_ffmpeg_find_encoder_by_name(js_env_t *env, js_receiver_t, std::string name) {
-  int err;
-
-  const AVCodec *encoder = avcodec_find_encoder_by_name(name.c_str());
-
-  if (encoder == NULL) {
-    err = js_throw_errorf(env, NULL, "No encoder found with name '%s'", name.c_str());
-    assert(err == 0);
+  if (is_exception_pending) {
+    avformat_close_input(&context->handle);
 
     throw js_pending_exception;
   }
 
-  js_arraybuffer_t handle;
-  bare_ffmpeg_codec_t *context;
-  err = js_create_arraybuffer(env, context, handle);
-  assert(err == 0);
+  if (status < 0) {
+    avformat_close_input(&context->handle);
 
-  context->handle = encoder;
+    bare_ffmpeg__format_context_throw(env, context, status);
+  }
 
   return handle;
 }
 
-static std::string
-bare_ffmpeg_get_codec_name_by_id(js_env_t *env, js_receiver_t, uint32_t id) {
-  auto name = avcodec_get_name((enum AVCodecID) id);
-
-  return std::string(name);
-}
-
-static std::string
-bare_ffmpeg_get_sample_format_name_by_id(js_env_t *env, js_receiver_t, int id) {
-  return av_get_sample_fmt_name(static_cast<enum AVSampleFormat>(id));
-}
-
-static std::string
-bare_ffmpeg_get_pixel_format_name_by_id(js_env_t *env, js_receiver_t, int id) {
-  return av_get_pix_fmt_name(static_cast<enum AVPixelFormat>(id));
-}
-
-static std::vector<int32_t>
-bare_ffmpeg_codec_get_supported_config(
+static void
+bare_ffmpeg_format_context_close_input(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_t, 1> codec,
-  int32_t cfg
+  js_arraybuffer_span_of_t<bare_ffmpeg_format_context_t, 1> context
 ) {
-  int err;
-
-  int count = 0;
-  const void *list = nullptr;
-
-  err = avcodec_get_supported_config(context->handle, codec->handle, static_cast<AVCodecConfig>(cfg), 0, &list, &count);
-  if (err < 0) {
-    err = js_throw_error(env, NULL, av_err2str(err));
-    assert(err == 0);
-
-    throw js_pending_exception;
-  }
-
-  std::vector<int32_t> values;
-
-  if (count > 0 && list) {
-    const int32_t *int_list = static_cast<const int32_t *>(list);
-    for (int i = 0; i < count; i++) {
-      values.push_back(int_list[i]);
-    }
-    return values;
-  }
-
-  switch (static_cast<AVCodecConfig>(cfg)) {
-  case AV_CODEC_CONFIG_PIX_FORMAT:
-    for (int i = 0; i < AV_PIX_FMT_NB; i++) {
-      if (av_pix_fmt_desc_get(static_cast<AVPixelFormat>(i)) != nullptr) {
-        values.push_back(i);
-      }
-    }
-    break;
-  case AV_CODEC_CONFIG_SAMPLE_FORMAT:
-    for (int i = 0; i < AV_SAMPLE_FMT_NB; i++) {
-      values.push_back(i);
-    }
-    break;
-  case AV_CODEC_CONFIG_COLOR_RANGE:
-    values.push_back(AVCOL_RANGE_UNSPECIFIED);
-    values.push_back(AVCOL_RANGE_MPEG);
-    values.push_back(AVCOL_RANGE_JPEG);
-    break;
-  case AV_CODEC_CONFIG_COLOR_SPACE:
-    for (int i = 0; i < AVCOL_SPC_NB; i++) {
-      values.push_back(i);
-    }
-    break;
-  case AV_CODEC_CONFIG_SAMPLE_RATE:
-    values.push_back(0);
-    break;
-  default:
-    break;
-  }
-
-  return values;
+  avformat_close_input(&context->handle);
 }
 
-static std::optional<js_arraybuffer_t>
-bare_ffmpeg_codec_get_supported_frame_rates(
+static js_arraybuffer_t
+bare_ffmpeg_format_context_open_output(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_t, 1> codec
+  js_arraybuffer_span_of_t<bare_ffmpeg_output_format_t, 1> format,
+  js_arraybuffer_span_of_t<bare_ffmpeg_io_context_t, 1> io
 ) {
   int err;
 
-  const AVCodecContext *ctx = context->handle;
-  const AVCodec *c = codec->handle;
+  js_arraybuffer_t handle;
 
-  int count = 0;
-  const void *list = nullptr;
+  bare_ffmpeg_format_context_t *context;
+  err = js_create_arraybuffer(env, context, handle);
+  assert(err == 0);
 
-  err = avcodec_get_supported_config(ctx, c, AV_CODEC_CONFIG_FRAME_RATE, 0, &list, &count);
+  err = avformat_alloc_output_context2(&context->handle, format->handle, NULL, NULL);
   if (err < 0) {
     err = js_throw_error(env, NULL, av_err2str(err));
     assert(err == 0);
@@ -1182,41 +1879,28 @@ bare_ffmpeg_codec_get_supported_frame_rates(
     throw js_pending_exception;
   }
 
-  if (!list || count == 0) {
-    return std::nullopt;
-  }
-
-  js_arraybuffer_t result;
-  int32_t *data;
-  err = js_create_arraybuffer(env, static_cast<size_t>(count * 2), data, result);
-  assert(err == 0);
-
-  const AVRational *rational_list = static_cast<const AVRational *>(list);
-  for (int i = 0; i < count; i++) {
-    data[i * 2] = rational_list[i].num;
-    data[i * 2 + 1] = rational_list[i].den;
-  }
+  context->handle->pb = io->handle;
+  context->handle->opaque = (void *) context;
 
-  return result;
+  return handle;
 }
 
-static std::optional<std::vector<js_arraybuffer_t>>
-bare_ffmpeg_codec_get_supported_channel_layouts(
+static js_arraybuffer_t
+bare_ffmpeg_format_context_open_output_with_path(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_t, 1> codec
+  js_arraybuffer_span_of_t<bare_ffmpeg_output_format_t, 1> format,
+  std::string path
 ) {
   int err;
-  std::vector<js_arraybuffer_t> result;
 
-  const AVCodecContext *ctx = context->handle;
-  const AVCodec *c = codec->handle;
+  js_arraybuffer_t handle;
 
-  int count = 0;
-  const void *list = nullptr;
+  bare_ffmpeg_format_context_t *context;
+  err = js_create_arraybuffer(env, context, handle);
+  assert(err == 0);
 
-  err = avcodec_get_supported_config(ctx, c, AV_CODEC_CONFIG_CHANNEL_LAYOUT, 0, &list, &count);
+  err = avformat_alloc_output_context2(&context->handle, format->handle, NULL, path.c_str());
   if (err < 0) {
     err = js_throw_error(env, NULL, av_err2str(err));
     assert(err == 0);
@@ -1224,688 +1908,2433 @@ bare_ffmpeg_codec_get_supported_channel_layouts(
     throw js_pending_exception;
   }
 
-  if (!list || count == 0) {
-    return std::nullopt;
-  }
-
-  const AVChannelLayout *layout_list = static_cast<const AVChannelLayout *>(list);
-  for (int i = 0; i < count; i++) {
-    js_arraybuffer_t handle;
-    bare_ffmpeg_channel_layout_t *layout;
-    err = js_create_arraybuffer(env, layout, handle);
-    assert(err == 0);
-
-    err = av_channel_layout_copy(&layout->handle, &layout_list[i]);
-    assert(err >= 0);
-
-    result.push_back(handle);
-  }
-
-  return result;
-}
+  context->handle->opaque = (void *) context;
 
-static js_arraybuffer_t
-bare_ffmpeg_codec_context_init(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_t, 1> codec
-) {
-  int err;
+  // The file is written natively, seeking back for trailers such as the MP4
+  // moov atom, without ever calling into JavaScript
+  if ((format->handle->flags & AVFMT_NOFILE) == 0) {
+    err = avio_open2(&context->handle->pb, path.c_str(), AVIO_FLAG_WRITE, NULL, NULL);
+    if (err < 0) {
+      avformat_free_context(context->handle);
 
-  js_arraybuffer_t handle;
+      err = js_throw_error(env, NULL, av_err2str(err));
+      assert(err == 0);
 
-  bare_ffmpeg_codec_context_t *context;
-  err = js_create_arraybuffer(env, context, handle);
-  assert(err == 0);
+      throw js_pending_exception;
+    }
 
-  context->handle = avcodec_alloc_context3(codec->handle);
-  context->handle->opaque = (void *) context;
+    context->owns_io = true;
+  }
 
   return handle;
 }
 
-static void
-bare_ffmpeg_codec_context_destroy(
+static std::string
+bare_ffmpeg_output_format_get_extensions(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
+  js_arraybuffer_span_of_t<bare_ffmpeg_output_format_t, 1> context
 ) {
-  avcodec_free_context(&context->handle);
-  context->get_format_cb.reset();
+  return context->handle->extensions;
 }
 
-static bool
-bare_ffmpeg_codec_context_open(
+static std::string
+bare_ffmpeg_output_format_get_mime_type(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
+  js_arraybuffer_span_of_t<bare_ffmpeg_output_format_t, 1> context
 ) {
-  int err;
-
-  err = avcodec_open2(context->handle, context->handle->codec, NULL);
-  if (err < 0) {
-    err = js_throw_error(env, NULL, av_err2str(err));
-    assert(err == 0);
-
-    throw js_pending_exception;
-  }
-
-  return err == 0;
+  return context->handle->mime_type;
 }
 
-static int32_t
-bare_ffmpeg_codec_context_get_flags(
+static std::string
+bare_ffmpeg_output_format_get_name(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
+  js_arraybuffer_span_of_t<bare_ffmpeg_output_format_t, 1> context
 ) {
-  return context->handle->flags;
+  return context->handle->name;
 }
 
 static void
-bare_ffmpeg_codec_context_set_flags(
+bare_ffmpeg_format_context_close_output(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
-  int32_t value
+  js_arraybuffer_span_of_t<bare_ffmpeg_format_context_t, 1> context
 ) {
-  context->handle->flags = value;
+  if (context->owns_io) {
+    avio_closep(&context->handle->pb);
+
+    context->owns_io = false;
+  }
+
+  avformat_free_context(context->handle);
 }
 
-static js_arraybuffer_t
-bare_ffmpeg_codec_context_get_extra_data(
+static js_array_t
+bare_ffmpeg_format_context_get_streams(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
+  js_arraybuffer_span_of_t<bare_ffmpeg_format_context_t, 1> context
 ) {
-  js_arraybuffer_t buffer;
-  int err = js_create_arraybuffer(
-    env,
-    context->handle->extradata,
-    static_cast<size_t>(context->handle->extradata_size),
-    buffer
-  );
-  assert(err == 0);
+  int err;
 
-  return buffer;
-}
+  auto len = context->handle->nb_streams;
 
-void
-bare_ffmpeg_codec_context_set_extra_data(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
-  js_arraybuffer_t buffer,
-  uint32_t offset,
-  uint32_t len
-) {
-  std::span<uint8_t> view;
-  int err = js_get_arraybuffer_info(env, buffer, view);
+  js_array_t result;
+  err = js_create_array(env, len, result);
   assert(err == 0);
 
-  if (context->handle->extradata_size) {
-    av_free(context->handle->extradata);
-  }
+  for (uint32_t i = 0; i < len; i++) {
+    js_arraybuffer_t handle;
 
-  context->handle->extradata = reinterpret_cast<uint8_t *>(av_malloc(len + AV_INPUT_BUFFER_PADDING_SIZE));
+    bare_ffmpeg_stream_t *stream;
+    err = js_create_arraybuffer(env, stream, handle);
+    assert(err == 0);
 
-  memset(&context->handle->extradata[len], 0, AV_INPUT_BUFFER_PADDING_SIZE);
-  memcpy(context->handle->extradata, &view[offset], len);
+    stream->handle = context->handle->streams[i];
 
-  context->handle->extradata_size = static_cast<int>(len);
+    err = js_set_element(env, result, i, handle);
+    assert(err == 0);
+  }
+
+  return result;
 }
 
-static int
-bare_ffmpeg_frame_get_format(
+static int64_t
+bare_ffmpeg_format_context_get_duration(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame
+  js_arraybuffer_span_of_t<bare_ffmpeg_format_context_t, 1> context
 ) {
-  return frame->handle->format;
+  if (context->handle->duration == AV_NOPTS_VALUE) return -1;
+
+  return context->handle->duration;
 }
 
-static void
-bare_ffmpeg_frame_set_format(
+static int
+bare_ffmpeg_format_context_get_best_stream_index(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame,
-  int format
+  js_arraybuffer_span_of_t<bare_ffmpeg_format_context_t, 1> context,
+  int32_t type
 ) {
-  frame->handle->format = format;
+  auto i = av_find_best_stream(context->handle, static_cast<AVMediaType>(type), -1, -1, NULL, 0);
+
+  if (i < 0) i = -1;
+
+  return i;
 }
 
 static js_arraybuffer_t
-bare_ffmpeg_frame_get_channel_layout(
+bare_ffmpeg_format_context_create_stream(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame
+  js_arraybuffer_span_of_t<bare_ffmpeg_format_context_t, 1> context
 ) {
   int err;
 
-  js_arraybuffer_t result;
-
-  bare_ffmpeg_channel_layout_t *layout;
-  err = js_create_arraybuffer(env, layout, result);
-  assert(err == 0);
+  js_arraybuffer_t handle;
 
-  err = av_channel_layout_copy(&layout->handle, &frame->handle->ch_layout);
+  bare_ffmpeg_stream_t *stream;
+  err = js_create_arraybuffer(env, stream, handle);
   assert(err == 0);
 
-  return result;
+  stream->handle = avformat_new_stream(context->handle, NULL);
+  return handle;
 }
 
 static void
-bare_ffmpeg_frame_set_channel_layout(
+bare_ffmpeg_format_context_abort(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame,
-  js_arraybuffer_span_of_t<bare_ffmpeg_channel_layout_t, 1> layout
+  js_arraybuffer_span_of_t<bare_ffmpeg_format_context_t, 1> context
 ) {
-  int err;
+  context->interrupt.aborted = true;
 
-  err = av_channel_layout_copy(&frame->handle->ch_layout, &layout->handle);
-  assert(err == 0);
+  if (context->handle == NULL) return;
+
+  auto io = context->handle->pb;
+
+  // Wake up a worker waiting for pushed data
+  if (io && io->read_packet == bare_ffmpeg__on_io_context_stream_read) {
+    auto stream = static_cast<bare_ffmpeg_io_context_t *>(io->opaque)->stream;
+
+    uv_mutex_lock(&stream->lock);
+
+    uv_cond_broadcast(&stream->readable);
+
+    uv_mutex_unlock(&stream->lock);
+  }
 }
 
 static void
-bare_ffmpeg_frame_copy_properties(
+bare_ffmpeg_format_context_set_timeout(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> dst,
-  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> src
+  js_arraybuffer_span_of_t<bare_ffmpeg_format_context_t, 1> context,
+  uint32_t timeout
 ) {
-  int err = av_frame_copy_props(dst->handle, src->handle);
-
-  if (err < 0) {
-    err = js_throw_error(env, NULL, av_err2str(err));
-    assert(err == 0);
-
-    throw js_pending_exception;
-  }
+  context->interrupt.timeout = static_cast<uint64_t>(timeout) * 1000000;
 }
 
-static std::vector<std::tuple<const char *, const char *>>
-bare_ffmpeg_frame_get_metadata_entries(
+static bool
+bare_ffmpeg_format_context_read_frame(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame
+  js_arraybuffer_span_of_t<bare_ffmpeg_format_context_t, 1> context,
+  js_arraybuffer_span_of_t<bare_ffmpeg_packet_t, 1> packet
 ) {
-  std::vector<std::tuple<const char *, const char *>> entries{};
+  int err;
 
-  AVDictionary *dict = frame->handle->metadata;
-  if (!dict) return entries;
+  bare_ffmpeg__io_context_check_source(env, context->handle->pb);
 
-  const AVDictionaryEntry *entry = nullptr;
+  if (context->deferred_status < 0) {
+    err = context->deferred_status;
 
-  while ((entry = av_dict_iterate(dict, entry))) {
-    entries.emplace_back(entry->key, entry->value);
+    context->deferred_status = 0;
+
+    bare_ffmpeg__format_context_throw(env, context, err);
   }
 
-  return entries;
-}
+  av_packet_unref(packet->handle);
 
-static std::optional<std::string>
-bare_ffmpeg_frame_get_metadata_entry(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame,
-  std::string key
-) {
-  AVDictionary *dict = frame->handle->metadata;
-  if (!dict) return std::nullopt;
+  bare_ffmpeg__interrupt_arm(&context->interrupt);
 
-  AVDictionaryEntry *entry = av_dict_get(dict, key.c_str(), nullptr, 0);
-  if (entry == NULL) return std::nullopt;
+  err = av_read_frame(context->handle, packet->handle);
 
-  return entry->value;
+  bare_ffmpeg__interrupt_disarm(&context->interrupt);
+
+  if (err < 0 && err != AVERROR(EAGAIN) && err != AVERROR_EOF) {
+    bare_ffmpeg__format_context_throw(env, context, err);
+  }
+
+  bare_ffmpeg__packet_sync(packet->handle, packet->header);
+
+  return err == 0;
 }
 
-static std::vector<js_arraybuffer_t>
-bare_ffmpeg_frame_get_side_data(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame
-) {
-  std::vector<js_arraybuffer_t> res{};
+static bool
+bare_ffmpeg__io_context_calls_js(AVIOContext *io) {
+  if (io == NULL) return false;
+
+  return (
+    io->read_packet == bare_ffmpeg__on_io_context_read ||
+    io->write_packet == bare_ffmpeg__on_io_context_write ||
+    io->write_packet == bare_ffmpeg__on_io_context_coalesced_write ||
+    io->seek == bare_ffmpeg__on_io_context_seek
+  );
+}
 
-  int count = frame->handle->nb_side_data;
-  if (count <= 0 || frame->handle->side_data == nullptr) return res;
+static bare_ffmpeg_format_context_job_t *
+bare_ffmpeg__format_context_job_init(js_env_t *env, js_arraybuffer_t context_handle, bare_ffmpeg_format_context_t *context, AVIOContext *io, bare_ffmpeg_format_context_job_cb_t on_complete) {
+  int err;
 
-  for (int i = 0; i < count; i++) {
-    js_arraybuffer_t handle;
-    bare_ffmpeg_frame_side_data_t *sd;
-    int err = js_create_arraybuffer(env, sd, handle);
+  if (bare_ffmpeg__io_context_calls_js(io)) {
+    err = js_throw_error(env, NULL, "Asynchronous operations are not supported with JavaScript I/O callbacks");
     assert(err == 0);
 
-    sd->handle = frame->handle->side_data[i];
-
-    res.push_back(handle);
+    throw js_pending_exception;
   }
 
-  return res;
-}
+  bare_ffmpeg__io_context_check_source(env, io);
 
-static int
-bare_ffmpeg_frame_side_data_get_type(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_frame_side_data_t, 1> side_data
-) {
-  return side_data->handle->type;
-}
+  auto job = new bare_ffmpeg_format_context_job_t();
 
-static std::string
-bare_ffmpeg_frame_side_data_get_name(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_frame_side_data_t, 1> side_data
-) {
-  return av_frame_side_data_name(side_data->handle->type);
-}
+  job->env = env;
+  job->context = context;
 
-static js_arraybuffer_t
-bare_ffmpeg_frame_side_data_get_data(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_frame_side_data_t, 1> side_data
-) {
-  js_arraybuffer_t handle;
-  uint8_t *buf;
-  int err = js_create_arraybuffer(env, side_data->handle->size, buf, handle);
+  err = js_create_reference(env, context_handle, job->context_ref);
   assert(err == 0);
 
-  memcpy(buf, side_data->handle->data, side_data->handle->size);
+  err = js_create_reference(env, on_complete, job->on_complete);
+  assert(err == 0);
 
-  return handle;
+  return job;
 }
 
 static void
-bare_ffmpeg_frame_transfer_data(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> dst,
-  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> src
-) {
-  int err = av_hwframe_transfer_data(dst->handle, src->handle, 0);
+bare_ffmpeg__on_format_context_job_done(uv_work_t *handle, int status) {
+  int err;
 
-  if (err < 0) {
-    err = js_throw_error(env, NULL, av_err2str(err));
-    assert(err == 0);
+  auto job = reinterpret_cast<bare_ffmpeg_format_context_job_t *>(handle);
 
-    throw js_pending_exception;
-  }
-}
+  auto env = job->env;
 
-static void
-bare_ffmpeg_frame_map(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> dst,
-  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> src,
-  int32_t flags
-) {
-  int err = av_hwframe_map(dst->handle, src->handle, flags);
+  js_handle_scope_t *scope;
+  err = js_open_handle_scope(env, &scope);
+  assert(err == 0);
 
-  if (err < 0) {
-    err = js_throw_error(env, NULL, av_err2str(err));
-    assert(err == 0);
+  int32_t result = job->status;
 
-    throw js_pending_exception;
-  }
-}
+  if (job->target_packet) {
+    if (result == 0) {
+      if (job->target_packet->handle) {
+        av_packet_unref(job->target_packet->handle);
+        av_packet_move_ref(job->target_packet->handle, job->packet);
 
-static std::optional<js_arraybuffer_t>
-bare_ffmpeg_frame_get_hw_frames_ctx(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame
-) {
-  int err;
+        bare_ffmpeg__packet_sync(job->target_packet->handle, job->target_packet->header);
+      }
 
-  if (frame->handle->hw_frames_ctx == nullptr) {
-    return std::nullopt;
+      result = 1;
+    } else if (result == AVERROR(EAGAIN) || result == AVERROR_EOF) {
+      result = 0;
+    }
   }
 
-  js_arraybuffer_t handle;
-  bare_ffmpeg_hw_frames_context_t *hw_frames_ctx;
-  err = js_create_arraybuffer(env, hw_frames_ctx, handle);
+  bare_ffmpeg_format_context_job_cb_t callback;
+  err = js_get_reference_value(env, job->on_complete, callback);
   assert(err == 0);
 
-  hw_frames_ctx->handle = av_buffer_ref(frame->handle->hw_frames_ctx);
+  job->context_ref.reset();
+  job->target_ref.reset();
+  job->on_complete.reset();
 
-  return handle;
+  av_packet_free(&job->packet);
+
+  delete job;
+
+  err = js_call_function(env, callback, result);
+  assert(err == 0);
+
+  err = js_close_handle_scope(env, scope);
+  assert(err == 0);
 }
 
 static void
-bare_ffmpeg_frame_set_side_data(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame,
-  std::vector<js_object_t> side_data_array
-) {
-  for (js_object_t side_data : side_data_array) {
-    int err;
+bare_ffmpeg__format_context_job_queue(js_env_t *env, bare_ffmpeg_format_context_job_t *job, uv_work_cb work) {
+  int err;
 
-    int32_t type;
-    err = js_get_property(env, side_data, "type", type);
-    assert(err == 0);
+  uv_loop_t *loop;
+  err = js_get_env_loop(env, &loop);
+  assert(err == 0);
 
-    js_arraybuffer_span_t buf;
-    err = js_get_property(env, side_data, "buffer", buf);
-    assert(err == 0);
+  err = uv_queue_work(loop, &job->handle, work, bare_ffmpeg__on_format_context_job_done);
+  assert(err == 0);
+}
 
-    int32_t offset;
-    err = js_get_property(env, side_data, "offset", offset);
-    assert(err == 0);
+static void
+bare_ffmpeg__on_format_context_open_input(uv_work_t *handle) {
+  auto job = reinterpret_cast<bare_ffmpeg_format_context_job_t *>(handle);
 
-    int32_t len;
-    err = js_get_property(env, side_data, "length", len);
-    assert(err == 0);
+  auto context = job->context;
 
-    AVFrameSideData *sd = av_frame_new_side_data(
-      frame->handle,
-      static_cast<AVFrameSideDataType>(type),
-      static_cast<size_t>(len)
-    );
+  // The deadline starts once a worker picks up the job
+  bare_ffmpeg__interrupt_arm(&context->interrupt);
 
-    if (!sd) {
-      err = js_throw_error(env, NULL, "unable to allocate frame side data");
-      assert(err == 0);
-      throw js_pending_exception;
-    }
+  // Both calls free the context on failure and leave the handle NULL
+  job->status = avformat_open_input(&context->handle, NULL, NULL, NULL);
 
-    if (len > 0) {
-      memcpy(sd->data, &buf[static_cast<size_t>(offset)], static_cast<size_t>(len));
-    }
+  if (job->status >= 0 && job->find_stream_info) {
+    job->status = avformat_find_stream_info(context->handle, NULL);
+    if (job->status < 0) avformat_close_input(&context->handle);
   }
-}
 
-static void
-bare_ffmpeg_frame_remove_side_data(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame,
-  int32_t type
-) {
-  av_frame_remove_side_data(
-    frame->handle,
-    static_cast<AVFrameSideDataType>(type)
-  );
+  bare_ffmpeg__interrupt_disarm(&context->interrupt);
 }
 
 static void
-bare_ffmpeg_frame_set_hw_frames_ctx(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame,
-  js_arraybuffer_span_of_t<bare_ffmpeg_hw_frames_context_t, 1> hw_frames_ctx
-) {
-  if (frame->handle->hw_frames_ctx != nullptr) {
-    av_buffer_unref(&frame->handle->hw_frames_ctx);
-  }
+bare_ffmpeg__on_format_context_read_frame(uv_work_t *handle) {
+  auto job = reinterpret_cast<bare_ffmpeg_format_context_job_t *>(handle);
 
-  frame->handle->hw_frames_ctx = av_buffer_ref(hw_frames_ctx->handle);
+  auto context = job->context;
+
+  bare_ffmpeg__interrupt_arm(&context->interrupt);
+
+  job->status = av_read_frame(context->handle, job->packet);
+
+  bare_ffmpeg__interrupt_disarm(&context->interrupt);
 }
 
-static bool
-bare_ffmpeg_codec_context_open_with_options(
+static js_arraybuffer_t
+bare_ffmpeg_format_context_open_input_with_io_async(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
-  js_arraybuffer_span_of_t<bare_ffmpeg_dictionary_t, 1> options
+  js_arraybuffer_span_of_t<bare_ffmpeg_io_context_t, 1> io,
+  uint32_t timeout,
+  int64_t probesize,
+  int64_t analyzeduration,
+  int32_t fpsprobesize,
+  bool find_stream_info,
+  bare_ffmpeg_format_context_job_cb_t callback
 ) {
   int err;
 
-  err = avcodec_open2(context->handle, context->handle->codec, &options->handle);
-  if (err < 0) {
-    err = js_throw_error(env, NULL, av_err2str(err));
-    assert(err == 0);
+  js_arraybuffer_t handle;
 
-    throw js_pending_exception;
-  }
+  bare_ffmpeg_format_context_t *context;
+  err = js_create_arraybuffer(env, context, handle);
+  assert(err == 0);
 
-  return err == 0;
-}
+  auto job = bare_ffmpeg__format_context_job_init(env, handle, context, io->handle, callback);
 
-static int64_t
-bare_ffmpeg_codec_context_get_pixel_format(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
-) {
-  return context->handle->pix_fmt;
-}
+  context->handle = avformat_alloc_context();
+  context->handle->pb = io->handle;
+  context->handle->opaque = (void *) context;
 
-static void
-bare_ffmpeg_codec_context_set_pixel_format(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
-  int32_t value
-) {
-  context->handle->pix_fmt = static_cast<AVPixelFormat>(value);
-}
+  bare_ffmpeg__format_context_init_interrupt(context, timeout);
+  bare_ffmpeg__format_context_init_probe(context, probesize, analyzeduration, fpsprobesize);
 
-static int64_t
-bare_ffmpeg_codec_context_get_width(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
-) {
-  return context->handle->width;
-}
+  job->find_stream_info = find_stream_info;
 
-static void
-bare_ffmpeg_codec_context_set_width(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
-  int value
-) {
-  context->handle->width = value;
-}
+  bare_ffmpeg__format_context_job_queue(env, job, bare_ffmpeg__on_format_context_open_input);
 
-static int64_t
-bare_ffmpeg_codec_context_get_height(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
-) {
-  return context->handle->height;
+  return handle;
 }
 
 static void
-bare_ffmpeg_codec_context_set_height(
+bare_ffmpeg_format_context_read_frame_async(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
-  int value
+  js_arraybuffer_t context_handle,
+  js_arraybuffer_t packet,
+  bare_ffmpeg_format_context_job_cb_t callback
 ) {
-  context->handle->height = value;
-}
+  int err;
 
-static int64_t
-bare_ffmpeg_codec_context_get_sample_format(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
-) {
-  return context->handle->sample_fmt;
-}
+  std::span<uint8_t> view;
 
-static void
-bare_ffmpeg_codec_context_set_sample_format(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
-  int32_t value
-) {
-  context->handle->sample_fmt = static_cast<AVSampleFormat>(value);
+  err = js_get_arraybuffer_info(env, context_handle, view);
+  assert(err == 0);
+
+  auto context = reinterpret_cast<bare_ffmpeg_format_context_t *>(view.data());
+
+  err = js_get_arraybuffer_info(env, packet, view);
+  assert(err == 0);
+
+  auto job = bare_ffmpeg__format_context_job_init(env, context_handle, context, context->handle->pb, callback);
+
+  // Demux into a private packet and move it into the target on completion so
+  // the target is never touched from the worker.
+  job->packet = av_packet_alloc();
+  job->target_packet = reinterpret_cast<bare_ffmpeg_packet_t *>(view.data());
+
+  err = js_create_reference(env, packet, job->target_ref);
+  assert(err == 0);
+
+  bare_ffmpeg__format_context_job_queue(env, job, bare_ffmpeg__on_format_context_read_frame);
 }
 
-static js_arraybuffer_t
-bare_ffmpeg_codec_context_get_time_base(
+static int32_t
+bare_ffmpeg_format_context_read_frames(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
+  js_arraybuffer_span_of_t<bare_ffmpeg_format_context_t, 1> context,
+  std::vector<js_arraybuffer_t> packets,
+  js_arraybuffer_span_t metadata
 ) {
   int err;
 
-  js_arraybuffer_t result;
+  assert(metadata.size() >= packets.size() * 6 * sizeof(double));
 
-  int32_t *data;
-  err = js_create_arraybuffer(env, 2, data, result);
-  assert(err == 0);
+  bare_ffmpeg__io_context_check_source(env, context->handle->pb);
 
-  data[0] = context->handle->time_base.num;
-  data[1] = context->handle->time_base.den;
+  if (context->deferred_status < 0) {
+    err = context->deferred_status;
 
-  return result;
+    context->deferred_status = 0;
+
+    bare_ffmpeg__format_context_throw(env, context, err);
+  }
+
+  auto data = reinterpret_cast<double *>(metadata.data());
+
+  int32_t count = 0;
+
+  // The deadline covers the whole batch
+  bare_ffmpeg__interrupt_arm(&context->interrupt);
+
+  for (auto &handle : packets) {
+    std::span<uint8_t> view;
+    err = js_get_arraybuffer_info(env, handle, view);
+    assert(err == 0);
+
+    auto target = reinterpret_cast<bare_ffmpeg_packet_t *>(view.data());
+
+    auto packet = target->handle;
+
+    av_packet_unref(packet);
+
+    err = av_read_frame(context->handle, packet);
+
+    bare_ffmpeg__packet_sync(packet, target->header);
+
+    if (err < 0) {
+      if (err == AVERROR(EAGAIN) || err == AVERROR_EOF) break;
+
+      // Hand back what was read so far and report the error on the next call.
+      if (count > 0) {
+        context->deferred_status = err;
+        break;
+      }
+
+      bare_ffmpeg__interrupt_disarm(&context->interrupt);
+
+      bare_ffmpeg__format_context_throw(env, context, err);
+    }
+
+    auto entry = &data[count * 6];
+
+    // Mirror the packet header, which reports missing timestamps as -1
+    entry[0] = target->header.stream_index;
+    entry[1] = target->header.pts;
+    entry[2] = target->header.dts;
+    entry[3] = target->header.duration;
+    entry[4] = target->header.flags;
+    entry[5] = target->header.size;
+
+    count++;
+  }
+
+  bare_ffmpeg__interrupt_disarm(&context->interrupt);
+
+  return count;
 }
 
 static void
-bare_ffmpeg_codec_context_set_time_base(
+bare_ffmpeg_format_context_seek_frame(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
-  int num,
-  int den
+  js_arraybuffer_span_of_t<bare_ffmpeg_format_context_t, 1> context,
+  int32_t stream_index,
+  int64_t timestamp,
+  int32_t flags
 ) {
-  context->handle->time_base.num = num;
-  context->handle->time_base.den = den;
+  int err;
+
+  bare_ffmpeg__io_context_check_source(env, context->handle->pb);
+
+  bare_ffmpeg__interrupt_arm(&context->interrupt);
+
+  err = av_seek_frame(context->handle, stream_index, timestamp, flags);
+
+  bare_ffmpeg__interrupt_disarm(&context->interrupt);
+
+  if (err < 0) bare_ffmpeg__format_context_throw(env, context, err);
 }
 
-static js_arraybuffer_t
-bare_ffmpeg_codec_context_get_channel_layout(
+static bool
+bare_ffmpeg_format_context_write_header(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
+  js_arraybuffer_span_of_t<bare_ffmpeg_format_context_t, 1> context,
+  std::optional<js_arraybuffer_span_of_t<bare_ffmpeg_dictionary_t, 1>> options
 ) {
   int err;
 
-  js_arraybuffer_t result;
+  if (options) {
+    err = avformat_write_header(context->handle, &options.value()->handle);
+  } else {
+    err = avformat_write_header(context->handle, NULL);
+  }
 
-  bare_ffmpeg_channel_layout_t *layout;
-  err = js_create_arraybuffer(env, layout, result);
-  assert(err == 0);
+  if (err < 0) {
+    err = js_throw_error(env, NULL, av_err2str(err));
+    assert(err == 0);
 
-  err = av_channel_layout_copy(&layout->handle, &context->handle->ch_layout);
-  assert(err == 0);
+    throw js_pending_exception;
+  }
 
-  return result;
+  return err;
 }
 
 static void
-bare_ffmpeg_codec_context_set_channel_layout(
+bare_ffmpeg_format_context_write_frame(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
-  js_arraybuffer_span_of_t<bare_ffmpeg_channel_layout_t, 1> layout
+  js_arraybuffer_span_of_t<bare_ffmpeg_format_context_t, 1> context,
+  js_arraybuffer_span_of_t<bare_ffmpeg_packet_t, 1> packet
 ) {
   int err;
 
-  err = av_channel_layout_copy(&context->handle->ch_layout, &layout->handle);
-  assert(err == 0);
-}
+  err = av_interleaved_write_frame(context->handle, packet->handle);
+  if (err < 0) {
+    err = js_throw_error(env, NULL, av_err2str(err));
+    assert(err == 0);
 
-static int
-bare_ffmpeg_codec_context_get_sample_rate(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
-) {
-  return context->handle->sample_rate;
+    throw js_pending_exception;
+  }
+
+  bare_ffmpeg__packet_sync(packet->handle, packet->header);
 }
 
 static void
-bare_ffmpeg_codec_context_set_sample_rate(
+bare_ffmpeg_format_context_write_trailer(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
-  int32_t sample_rate
+  js_arraybuffer_span_of_t<bare_ffmpeg_format_context_t, 1> context
 ) {
-  context->handle->sample_rate = sample_rate;
-}
+  int err;
 
-static int
-bare_ffmpeg_codec_context_get_gop_size(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
-) {
+  err = av_write_trailer(context->handle);
+  if (err < 0) {
+    err = js_throw_error(env, NULL, av_err2str(err));
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+}
+
+static bool
+bare_ffmpeg__remux_job_report(bare_ffmpeg_remux_job_t *job);
+
+static int
+bare_ffmpeg__remux_job_run(bare_ffmpeg_remux_job_t *job) {
+  int err;
+
+  auto input = job->input;
+  auto output = job->output;
+
+  // The requested range is relative to the start of the input
+  auto base = input->start_time == AV_NOPTS_VALUE ? 0 : input->start_time;
+
+  auto start_time = job->start_time == AV_NOPTS_VALUE ? AV_NOPTS_VALUE : base + job->start_time;
+  auto end_time = job->end_time == AV_NOPTS_VALUE ? AV_NOPTS_VALUE : base + job->end_time;
+
+  auto streams = job->stream_map.size();
+
+  if (streams > input->nb_streams) streams = input->nb_streams;
+
+  std::vector<bool> ended(streams, false);
+
+  size_t active = 0;
+
+  for (size_t i = 0; i < streams; i++) {
+    auto index = job->stream_map[i];
+
+    if (index < 0) continue;
+
+    if (index >= static_cast<int32_t>(output->nb_streams)) return AVERROR(EINVAL);
+
+    active++;
+  }
+
+  if (start_time != AV_NOPTS_VALUE) {
+    err = av_seek_frame(input, -1, start_time, AVSEEK_FLAG_BACKWARD);
+    if (err < 0) return err;
+  }
+
+  auto packet = av_packet_alloc();
+
+  err = 0;
+
+  while (active > 0) {
+    err = av_read_frame(input, packet);
+    if (err < 0) break;
+
+    auto i = static_cast<size_t>(packet->stream_index);
+
+    if (i >= streams || job->stream_map[i] < 0 || ended[i]) {
+      av_packet_unref(packet);
+      continue;
+    }
+
+    auto source = input->streams[i];
+    auto target = output->streams[job->stream_map[i]];
+
+    auto ts = packet->dts != AV_NOPTS_VALUE ? packet->dts : packet->pts;
+
+    if (ts != AV_NOPTS_VALUE) {
+      auto time = av_rescale_q(ts, source->time_base, AV_TIME_BASE_Q);
+
+      if (end_time != AV_NOPTS_VALUE && time >= end_time) {
+        ended[i] = true;
+        active--;
+
+        av_packet_unref(packet);
+        continue;
+      }
+
+      job->time = time - (start_time == AV_NOPTS_VALUE ? base : start_time);
+    }
+
+    if (start_time != AV_NOPTS_VALUE) {
+      auto offset = av_rescale_q(start_time, AV_TIME_BASE_Q, source->time_base);
+
+      if (packet->pts != AV_NOPTS_VALUE) packet->pts -= offset;
+      if (packet->dts != AV_NOPTS_VALUE) packet->dts -= offset;
+    }
+
+    av_packet_rescale_ts(packet, source->time_base, target->time_base);
+
+    packet->stream_index = target->index;
+    packet->pos = -1;
+
+    err = av_interleaved_write_frame(output, packet);
+    if (err < 0) break;
+
+    job->packets++;
+
+    if (!bare_ffmpeg__remux_job_report(job)) {
+      err = AVERROR_EXIT;
+      break;
+    }
+  }
+
+  av_packet_free(&packet);
+
+  if (err == AVERROR_EOF || active == 0) err = 0;
+
+  return err;
+}
+
+static void
+bare_ffmpeg__on_remux_job_close(uv_handle_t *handle) {
+  auto job = reinterpret_cast<bare_ffmpeg_remux_job_t *>(handle->data);
+
+  delete job;
+}
+
+static void
+bare_ffmpeg__remux_job_destroy(bare_ffmpeg_remux_job_t *job) {
+  job->input_ref.reset();
+  job->output_ref.reset();
+  job->on_progress.reset();
+  job->on_complete.reset();
+
+  if (job->threaded) {
+    uv_close(reinterpret_cast<uv_handle_t *>(&job->progress), bare_ffmpeg__on_remux_job_close);
+  } else {
+    delete job;
+  }
+}
+
+static bool
+bare_ffmpeg__remux_job_call_progress(bare_ffmpeg_remux_job_t *job) {
+  int err;
+
+  auto env = job->env;
+
+  bare_ffmpeg_remux_progress_cb_t callback;
+  err = js_get_reference_value(env, job->on_progress, callback);
+  assert(err == 0);
+
+  int64_t time = job->time;
+  int64_t packets = job->packets;
+
+  // The callback returns false to cancel the copy
+  bool result;
+  err = js_call_function<js_type_options_t{}, bool, int64_t, int64_t>(env, callback, time, packets, result);
+
+  if (err < 0 || !result) job->cancelled = true;
+
+  return !job->cancelled;
+}
+
+static bool
+bare_ffmpeg__remux_job_report(bare_ffmpeg_remux_job_t *job) {
+  int err;
+
+  if (job->threaded) {
+    // Sends are coalesced, so the loop thread sees at most one wakeup per
+    // iteration regardless of the packet rate
+    err = uv_async_send(&job->progress);
+    assert(err == 0);
+
+    return !job->cancelled;
+  }
+
+  if (job->packets % 256 != 0) return true;
+
+  js_handle_scope_t *scope;
+  err = js_open_handle_scope(job->env, &scope);
+  assert(err == 0);
+
+  auto success = bare_ffmpeg__remux_job_call_progress(job);
+
+  err = js_close_handle_scope(job->env, scope);
+  assert(err == 0);
+
+  return success;
+}
+
+static void
+bare_ffmpeg__on_remux_job_progress(uv_async_t *handle) {
+  int err;
+
+  auto job = reinterpret_cast<bare_ffmpeg_remux_job_t *>(handle->data);
+
+  if (job->cancelled) return;
+
+  js_handle_scope_t *scope;
+  err = js_open_handle_scope(job->env, &scope);
+  assert(err == 0);
+
+  bare_ffmpeg__remux_job_call_progress(job);
+
+  err = js_close_handle_scope(job->env, scope);
+  assert(err == 0);
+}
+
+static void
+bare_ffmpeg__on_remux_job_work(uv_work_t *handle) {
+  auto job = reinterpret_cast<bare_ffmpeg_remux_job_t *>(handle);
+
+  job->status = bare_ffmpeg__remux_job_run(job);
+}
+
+static void
+bare_ffmpeg__on_remux_job_done(uv_work_t *handle, int status) {
+  int err;
+
+  auto job = reinterpret_cast<bare_ffmpeg_remux_job_t *>(handle);
+
+  auto env = job->env;
+
+  js_handle_scope_t *scope;
+  err = js_open_handle_scope(env, &scope);
+  assert(err == 0);
+
+  int32_t result = job->status;
+  int64_t packets = job->packets;
+
+  bare_ffmpeg_remux_cb_t callback;
+  err = js_get_reference_value(env, job->on_complete, callback);
+  assert(err == 0);
+
+  bare_ffmpeg__remux_job_destroy(job);
+
+  err = js_call_function(env, callback, result, packets);
+  assert(err == 0);
+
+  err = js_close_handle_scope(env, scope);
+  assert(err == 0);
+}
+
+static void
+bare_ffmpeg_format_context_remux(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_t input_handle,
+  js_arraybuffer_t output_handle,
+  std::vector<int32_t> stream_map,
+  int64_t start_time,
+  int64_t duration,
+  bare_ffmpeg_remux_progress_cb_t on_progress,
+  bare_ffmpeg_remux_cb_t on_complete
+) {
+  int err;
+
+  std::span<uint8_t> view;
+
+  err = js_get_arraybuffer_info(env, input_handle, view);
+  assert(err == 0);
+
+  auto input = reinterpret_cast<bare_ffmpeg_format_context_t *>(view.data());
+
+  err = js_get_arraybuffer_info(env, output_handle, view);
+  assert(err == 0);
+
+  auto output = reinterpret_cast<bare_ffmpeg_format_context_t *>(view.data());
+
+  bare_ffmpeg__io_context_check_source(env, input->handle->pb);
+
+  auto job = new bare_ffmpeg_remux_job_t();
+
+  job->env = env;
+  job->input = input->handle;
+  job->output = output->handle;
+  job->stream_map = std::move(stream_map);
+  job->start_time = start_time < 0 ? AV_NOPTS_VALUE : start_time;
+  job->end_time = duration < 0 ? AV_NOPTS_VALUE : (start_time < 0 ? 0 : start_time) + duration;
+  job->time = 0;
+  job->packets = 0;
+  job->cancelled = false;
+
+  // Custom I/O backed by JavaScript callbacks must stay on the loop thread,
+  // everything else is moved to the thread pool
+  job->threaded = (
+    !bare_ffmpeg__io_context_calls_js(input->handle->pb) &&
+    !bare_ffmpeg__io_context_calls_js(output->handle->pb)
+  );
+
+  err = js_create_reference(env, on_progress, job->on_progress);
+  assert(err == 0);
+
+  err = js_create_reference(env, on_complete, job->on_complete);
+  assert(err == 0);
+
+  if (job->threaded) {
+    uv_loop_t *loop;
+    err = js_get_env_loop(env, &loop);
+    assert(err == 0);
+
+    err = js_create_reference(env, input_handle, job->input_ref);
+    assert(err == 0);
+
+    err = js_create_reference(env, output_handle, job->output_ref);
+    assert(err == 0);
+
+    err = uv_async_init(loop, &job->progress, bare_ffmpeg__on_remux_job_progress);
+    assert(err == 0);
+
+    job->progress.data = job;
+
+    err = uv_queue_work(loop, &job->handle, bare_ffmpeg__on_remux_job_work, bare_ffmpeg__on_remux_job_done);
+    assert(err == 0);
+  } else {
+    job->status = bare_ffmpeg__remux_job_run(job);
+
+    bool pending;
+    err = js_is_exception_pending(env, &pending);
+    assert(err == 0);
+
+    if (pending) {
+      bare_ffmpeg__remux_job_destroy(job);
+
+      throw js_pending_exception;
+    }
+
+    int32_t result = job->status;
+    int64_t packets = job->packets;
+
+    bare_ffmpeg__remux_job_destroy(job);
+
+    err = js_call_function(env, on_complete, result, packets);
+    if (err < 0) throw js_pending_exception;
+  }
+}
+
+static void
+bare_ffmpeg_format_context_dump(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_format_context_t, 1> context,
+  bool is_output,
+  int32_t index,
+  std::string url
+) {
+  av_dump_format(context->handle, index, url.c_str(), is_output);
+
+  for (int i = 0; i < context->handle->nb_streams; i++) {
+    auto stream = context->handle->streams[i];
+
+    av_log(NULL, AV_LOG_INFO, "  - stream=%i timebase=(%i / %i)\n", i, stream->time_base.num, stream->time_base.den);
+  }
+}
+
+static std::optional<js_arraybuffer_t>
+get_bare_ffmpeg_format_context_output_format(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_format_context_t, 1> context
+) {
+  int err;
+
+  if (!context->handle->oformat) return std::nullopt;
+
+  js_arraybuffer_t handle;
+
+  bare_ffmpeg_output_format_t *format;
+  err = js_create_arraybuffer(env, format, handle);
+  assert(err == 0);
+
+  format->handle = context->handle->oformat;
+
+  return handle;
+}
+
+static std::optional<js_arraybuffer_t>
+get_bare_ffmpeg_format_context_input_format(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_format_context_t, 1> context
+) {
+  int err;
+
+  if (!context->handle->iformat) return std::nullopt;
+
+  js_arraybuffer_t handle;
+
+  bare_ffmpeg_input_format_t *format;
+  err = js_create_arraybuffer(env, format, handle);
+  assert(err == 0);
+
+  format->handle = context->handle->iformat;
+
+  return handle;
+}
+
+static int32_t
+bare_ffmpeg_stream_get_index(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_stream_t, 1> stream
+) {
+  return stream->handle->index;
+}
+
+static int32_t
+bare_ffmpeg_stream_get_id(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_stream_t, 1> stream
+) {
+  return stream->handle->id;
+}
+
+static void
+bare_ffmpeg_stream_set_id(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_stream_t, 1> stream,
+  int32_t id
+) {
+  stream->handle->id = id;
+}
+
+static js_arraybuffer_t
+bare_ffmpeg_stream_get_time_base(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_stream_t, 1> stream
+) {
+  int err;
+
+  js_arraybuffer_t result;
+
+  int32_t *data;
+  err = js_create_arraybuffer(env, 2, data, result);
+  assert(err == 0);
+
+  data[0] = stream->handle->time_base.num;
+  data[1] = stream->handle->time_base.den;
+
+  return result;
+}
+
+static void
+bare_ffmpeg_stream_set_time_base(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_stream_t, 1> stream,
+  int num,
+  int den
+) {
+  stream->handle->time_base.num = num;
+  stream->handle->time_base.den = den;
+}
+
+static js_arraybuffer_t
+bare_ffmpeg_stream_get_avg_framerate(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_stream_t, 1> stream
+) {
+  int err;
+
+  js_arraybuffer_t result;
+
+  int32_t *data;
+  err = js_create_arraybuffer(env, 2, data, result);
+  assert(err == 0);
+
+  data[0] = stream->handle->avg_frame_rate.num;
+  data[1] = stream->handle->avg_frame_rate.den;
+
+  return result;
+}
+
+static void
+bare_ffmpeg_stream_set_avg_framerate(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_stream_t, 1> stream,
+  int num,
+  int den
+) {
+  stream->handle->avg_frame_rate.num = num;
+  stream->handle->avg_frame_rate.den = den;
+}
+
+static js_arraybuffer_t
+bare_ffmpeg_stream_get_codec_parameters(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_stream_t, 1> stream
+) {
+  int err;
+
+  js_arraybuffer_t handle;
+
+  bare_ffmpeg_codec_parameters_t *parameters;
+  err = js_create_arraybuffer(env, parameters, handle);
+  assert(err == 0);
+
+  parameters->handle = stream->handle->codecpar;
+
+  return handle;
+}
+
+static void
+bare_ffmpeg__stream_read_index_entry(const AVIndexEntry *entry, int64_t *data) {
+  data[0] = entry->timestamp;
+  data[1] = entry->pos;
+  data[2] = entry->size;
+  data[3] = entry->min_distance;
+  data[4] = entry->flags;
+}
+
+static js_arraybuffer_t
+bare_ffmpeg_stream_get_index_entries(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_stream_t, 1> stream
+) {
+  int err;
+
+  auto len = avformat_index_get_entries_count(stream->handle);
+
+  js_arraybuffer_t result;
+
+  int64_t *data;
+  err = js_create_arraybuffer(env, static_cast<size_t>(len) * 5, data, result);
+  assert(err == 0);
+
+  for (int i = 0; i < len; i++) {
+    bare_ffmpeg__stream_read_index_entry(avformat_index_get_entry(stream->handle, i), &data[i * 5]);
+  }
+
+  return result;
+}
+
+static std::optional<js_arraybuffer_t>
+bare_ffmpeg_stream_search_index_entry(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_stream_t, 1> stream,
+  int64_t timestamp,
+  int32_t flags
+) {
+  int err;
+
+  auto entry = avformat_index_get_entry_from_timestamp(stream->handle, timestamp, flags);
+
+  if (entry == NULL) return std::nullopt;
+
+  js_arraybuffer_t result;
+
+  int64_t *data;
+  err = js_create_arraybuffer(env, 5, data, result);
+  assert(err == 0);
+
+  bare_ffmpeg__stream_read_index_entry(entry, data);
+
+  return result;
+}
+
+static int64_t
+bare_ffmpeg_stream_get_duration(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_stream_t, 1> stream
+) {
+  if (stream->handle->duration == AV_NOPTS_VALUE) {
+    return 0;
+  }
+
+  return stream->handle->duration;
+}
+
+static std::vector<js_arraybuffer_t>
+bare_ffmpeg_stream_get_side_data(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_stream_t, 1> stream
+) {
+  std::vector<js_arraybuffer_t> res{};
+
+  AVCodecParameters *codecpar = stream->handle->codecpar;
+  int count = codecpar->nb_coded_side_data;
+  if (count == 0) return res;
+
+  for (int i = 0; i < count; i++) {
+    js_arraybuffer_t handle;
+    bare_ffmpeg_side_data_t *sd;
+    int err = js_create_arraybuffer(env, sd, handle);
+    assert(err == 0);
+
+    sd->handle = &codecpar->coded_side_data[i];
+
+    res.push_back(handle);
+  }
+
+  return res;
+}
+
+static void
+bare_ffmpeg_stream_set_duration(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_stream_t, 1> stream,
+  int64_t duration
+) {
+  stream->handle->duration = duration;
+}
+
+static js_arraybuffer_t
+bare_ffmpeg_find_decoder_by_id(js_env_t *env, js_receiver_t, uint32_t id) {
+  int err;
+
+  const AVCodec *decoder = avcodec_find_decoder((enum AVCodecID) id);
+
+  if (decoder == NULL) {
+    err = js_throw_errorf(env, NULL, "No decoder found for codec '%d'", id);
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  js_arraybuffer_t handle;
+
+  bare_ffmpeg_codec_t *context;
+  err = js_create_arraybuffer(env, context, handle);
+  assert(err == 0);
+
+  context->handle = decoder;
+
+  return handle;
+}
+
+static js_arraybuffer_t
+bare_ffmpeg_find_encoder_by_id(js_env_t *env, js_receiver_t, uint32_t id) {
+  int err;
+
+  const AVCodec *encoder = avcodec_find_encoder((enum AVCodecID) id);
+
+  if (encoder == NULL) {
+    err = js_throw_errorf(env, NULL, "No encoder found for codec '%d'", id);
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  js_arraybuffer_t handle;
+
+  bare_ffmpeg_codec_t *context;
+  err = js_create_arraybuffer(env, context, handle);
+  assert(err == 0);
+
+  context->handle = encoder;
+
+  return handle;
+}
+
+static js_arraybuffer_t
+bare_ffmpeg_find_decoder_by_name(js_env_t *env, js_receiver_t, std::string name) {
+  int err;
+
+  const AVCodec *decoder = avcodec_find_decoder_by_name(name.c_str());
+
+  if (decoder == NULL) {
+    err = js_throw_errorf(env, NULL, "No decoder found with name '%s'", name.c_str());
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  js_arraybuffer_t handle;
+  bare_ffmpeg_codec_t *context;
+  err = js_create_arraybuffer(env, context, handle);
+  assert(err == 0);
+
+  context->handle = decoder;
+
+  return handle;
+}
+
+static js_arraybuffer_t
+bare_ffmpeg_find_encoder_by_name(js_env_t *env, js_receiver_t, std::string name) {
+  int err;
+
+  const AVCodec *encoder = avcodec_find_encoder_by_name(name.c_str());
+
+  if (encoder == NULL) {
+    err = js_throw_errorf(env, NULL, "No encoder found with name '%s'", name.c_str());
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  js_arraybuffer_t handle;
+  bare_ffmpeg_codec_t *context;
+  err = js_create_arraybuffer(env, context, handle);
+  assert(err == 0);
+
+  context->handle = encoder;
+
+  return handle;
+}
+
+static std::string
+bare_ffmpeg_get_codec_name_by_id(js_env_t *env, js_receiver_t, uint32_t id) {
+  auto name = avcodec_get_name((enum AVCodecID) id);
+
+  return std::string(name);
+}
+
+static std::string
+bare_ffmpeg_get_sample_format_name_by_id(js_env_t *env, js_receiver_t, int id) {
+  return av_get_sample_fmt_name(static_cast<enum AVSampleFormat>(id));
+}
+
+static std::string
+bare_ffmpeg_get_pixel_format_name_by_id(js_env_t *env, js_receiver_t, int id) {
+  return av_get_pix_fmt_name(static_cast<enum AVPixelFormat>(id));
+}
+
+static std::vector<int32_t>
+bare_ffmpeg_codec_get_supported_config(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_t, 1> codec,
+  int32_t cfg
+) {
+  int err;
+
+  int count = 0;
+  const void *list = nullptr;
+
+  err = avcodec_get_supported_config(context->handle, codec->handle, static_cast<AVCodecConfig>(cfg), 0, &list, &count);
+  if (err < 0) {
+    err = js_throw_error(env, NULL, av_err2str(err));
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  std::vector<int32_t> values;
+
+  if (count > 0 && list) {
+    const int32_t *int_list = static_cast<const int32_t *>(list);
+    for (int i = 0; i < count; i++) {
+      values.push_back(int_list[i]);
+    }
+    return values;
+  }
+
+  switch (static_cast<AVCodecConfig>(cfg)) {
+  case AV_CODEC_CONFIG_PIX_FORMAT:
+    for (int i = 0; i < AV_PIX_FMT_NB; i++) {
+      if (av_pix_fmt_desc_get(static_cast<AVPixelFormat>(i)) != nullptr) {
+        values.push_back(i);
+      }
+    }
+    break;
+  case AV_CODEC_CONFIG_SAMPLE_FORMAT:
+    for (int i = 0; i < AV_SAMPLE_FMT_NB; i++) {
+      values.push_back(i);
+    }
+    break;
+  case AV_CODEC_CONFIG_COLOR_RANGE:
+    values.push_back(AVCOL_RANGE_UNSPECIFIED);
+    values.push_back(AVCOL_RANGE_MPEG);
+    values.push_back(AVCOL_RANGE_JPEG);
+    break;
+  case AV_CODEC_CONFIG_COLOR_SPACE:
+    for (int i = 0; i < AVCOL_SPC_NB; i++) {
+      values.push_back(i);
+    }
+    break;
+  case AV_CODEC_CONFIG_SAMPLE_RATE:
+    values.push_back(0);
+    break;
+  default:
+    break;
+  }
+
+  return values;
+}
+
+static std::optional<js_arraybuffer_t>
+bare_ffmpeg_codec_get_supported_frame_rates(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_t, 1> codec
+) {
+  int err;
+
+  const AVCodecContext *ctx = context->handle;
+  const AVCodec *c = codec->handle;
+
+  int count = 0;
+  const void *list = nullptr;
+
+  err = avcodec_get_supported_config(ctx, c, AV_CODEC_CONFIG_FRAME_RATE, 0, &list, &count);
+  if (err < 0) {
+    err = js_throw_error(env, NULL, av_err2str(err));
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  if (!list || count == 0) {
+    return std::nullopt;
+  }
+
+  js_arraybuffer_t result;
+  int32_t *data;
+  err = js_create_arraybuffer(env, static_cast<size_t>(count * 2), data, result);
+  assert(err == 0);
+
+  const AVRational *rational_list = static_cast<const AVRational *>(list);
+  for (int i = 0; i < count; i++) {
+    data[i * 2] = rational_list[i].num;
+    data[i * 2 + 1] = rational_list[i].den;
+  }
+
+  return result;
+}
+
+static std::optional<std::vector<js_arraybuffer_t>>
+bare_ffmpeg_codec_get_supported_channel_layouts(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_t, 1> codec
+) {
+  int err;
+  std::vector<js_arraybuffer_t> result;
+
+  const AVCodecContext *ctx = context->handle;
+  const AVCodec *c = codec->handle;
+
+  int count = 0;
+  const void *list = nullptr;
+
+  err = avcodec_get_supported_config(ctx, c, AV_CODEC_CONFIG_CHANNEL_LAYOUT, 0, &list, &count);
+  if (err < 0) {
+    err = js_throw_error(env, NULL, av_err2str(err));
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  if (!list || count == 0) {
+    return std::nullopt;
+  }
+
+  const AVChannelLayout *layout_list = static_cast<const AVChannelLayout *>(list);
+  for (int i = 0; i < count; i++) {
+    js_arraybuffer_t handle;
+    bare_ffmpeg_channel_layout_t *layout;
+    err = js_create_arraybuffer(env, layout, handle);
+    assert(err == 0);
+
+    err = av_channel_layout_copy(&layout->handle, &layout_list[i]);
+    assert(err >= 0);
+
+    result.push_back(handle);
+  }
+
+  return result;
+}
+
+static js_arraybuffer_t
+bare_ffmpeg_codec_context_init(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_t, 1> codec
+) {
+  int err;
+
+  js_arraybuffer_t handle;
+
+  bare_ffmpeg_codec_context_t *context;
+  err = js_create_arraybuffer(env, context, handle);
+  assert(err == 0);
+
+  context->handle = avcodec_alloc_context3(codec->handle);
+  context->handle->opaque = (void *) context;
+
+  return handle;
+}
+
+static void
+bare_ffmpeg_codec_context_destroy(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
+) {
+  avcodec_free_context(&context->handle);
+  context->get_format_cb.reset();
+
+  if (context->buffer_pool) {
+    // Pools stay alive until every frame holding one of their buffers is
+    // released
+    for (int i = 0; i < 4; i++) {
+      av_buffer_pool_uninit(&context->buffer_pool->pools[i]);
+    }
+
+    delete context->buffer_pool;
+    context->buffer_pool = NULL;
+  }
+}
+
+static bool
+bare_ffmpeg_codec_context_open(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
+) {
+  int err;
+
+  err = avcodec_open2(context->handle, context->handle->codec, NULL);
+  if (err < 0) {
+    err = js_throw_error(env, NULL, av_err2str(err));
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  return err == 0;
+}
+
+static int32_t
+bare_ffmpeg_codec_context_get_flags(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
+) {
+  return context->handle->flags;
+}
+
+static void
+bare_ffmpeg_codec_context_set_flags(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
+  int32_t value
+) {
+  context->handle->flags = value;
+}
+
+static int32_t
+bare_ffmpeg_codec_context_get_thread_count(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
+) {
+  return context->handle->thread_count;
+}
+
+static void
+bare_ffmpeg_codec_context_set_thread_count(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
+  int32_t value
+) {
+  context->handle->thread_count = value;
+}
+
+static int32_t
+bare_ffmpeg_codec_context_get_thread_type(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
+) {
+  return context->handle->thread_type;
+}
+
+static void
+bare_ffmpeg_codec_context_set_thread_type(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
+  int32_t value
+) {
+  context->handle->thread_type = value;
+}
+
+static int32_t
+bare_ffmpeg_codec_context_get_capabilities(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
+) {
+  if (context->handle->codec == NULL) return 0;
+
+  return context->handle->codec->capabilities;
+}
+
+static js_arraybuffer_t
+bare_ffmpeg_codec_context_get_extra_data(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
+) {
+  js_arraybuffer_t buffer;
+  int err = js_create_arraybuffer(
+    env,
+    context->handle->extradata,
+    static_cast<size_t>(context->handle->extradata_size),
+    buffer
+  );
+  assert(err == 0);
+
+  return buffer;
+}
+
+void
+bare_ffmpeg_codec_context_set_extra_data(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
+  js_arraybuffer_t buffer,
+  uint32_t offset,
+  uint32_t len
+) {
+  std::span<uint8_t> view;
+  int err = js_get_arraybuffer_info(env, buffer, view);
+  assert(err == 0);
+
+  if (context->handle->extradata_size) {
+    av_free(context->handle->extradata);
+  }
+
+  context->handle->extradata = reinterpret_cast<uint8_t *>(av_malloc(len + AV_INPUT_BUFFER_PADDING_SIZE));
+
+  memset(&context->handle->extradata[len], 0, AV_INPUT_BUFFER_PADDING_SIZE);
+  memcpy(context->handle->extradata, &view[offset], len);
+
+  context->handle->extradata_size = static_cast<int>(len);
+}
+
+static int
+bare_ffmpeg_frame_get_format(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame
+) {
+  return frame->handle->format;
+}
+
+static void
+bare_ffmpeg_frame_set_format(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame,
+  int format
+) {
+  frame->handle->format = format;
+
+  bare_ffmpeg__frame_sync(frame->handle, frame->header);
+}
+
+static js_arraybuffer_t
+bare_ffmpeg_frame_get_channel_layout(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame
+) {
+  int err;
+
+  js_arraybuffer_t result;
+
+  bare_ffmpeg_channel_layout_t *layout;
+  err = js_create_arraybuffer(env, layout, result);
+  assert(err == 0);
+
+  err = av_channel_layout_copy(&layout->handle, &frame->handle->ch_layout);
+  assert(err == 0);
+
+  return result;
+}
+
+static void
+bare_ffmpeg_frame_set_channel_layout(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame,
+  js_arraybuffer_span_of_t<bare_ffmpeg_channel_layout_t, 1> layout
+) {
+  int err;
+
+  err = av_channel_layout_copy(&frame->handle->ch_layout, &layout->handle);
+  assert(err == 0);
+}
+
+static void
+bare_ffmpeg_frame_copy_properties(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> dst,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> src
+) {
+  int err = av_frame_copy_props(dst->handle, src->handle);
+
+  if (err < 0) {
+    err = js_throw_error(env, NULL, av_err2str(err));
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  bare_ffmpeg__frame_sync(dst->handle, dst->header);
+}
+
+static std::vector<std::tuple<const char *, const char *>>
+bare_ffmpeg_frame_get_metadata_entries(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame
+) {
+  std::vector<std::tuple<const char *, const char *>> entries{};
+
+  AVDictionary *dict = frame->handle->metadata;
+  if (!dict) return entries;
+
+  const AVDictionaryEntry *entry = nullptr;
+
+  while ((entry = av_dict_iterate(dict, entry))) {
+    entries.emplace_back(entry->key, entry->value);
+  }
+
+  return entries;
+}
+
+static std::optional<std::string>
+bare_ffmpeg_frame_get_metadata_entry(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame,
+  std::string key
+) {
+  AVDictionary *dict = frame->handle->metadata;
+  if (!dict) return std::nullopt;
+
+  AVDictionaryEntry *entry = av_dict_get(dict, key.c_str(), nullptr, 0);
+  if (entry == NULL) return std::nullopt;
+
+  return entry->value;
+}
+
+static std::vector<js_arraybuffer_t>
+bare_ffmpeg_frame_get_side_data(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame
+) {
+  std::vector<js_arraybuffer_t> res{};
+
+  int count = frame->handle->nb_side_data;
+  if (count <= 0 || frame->handle->side_data == nullptr) return res;
+
+  for (int i = 0; i < count; i++) {
+    js_arraybuffer_t handle;
+    bare_ffmpeg_frame_side_data_t *sd;
+    int err = js_create_arraybuffer(env, sd, handle);
+    assert(err == 0);
+
+    sd->handle = frame->handle->side_data[i];
+
+    res.push_back(handle);
+  }
+
+  return res;
+}
+
+static int
+bare_ffmpeg_frame_side_data_get_type(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_side_data_t, 1> side_data
+) {
+  return side_data->handle->type;
+}
+
+static std::string
+bare_ffmpeg_frame_side_data_get_name(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_side_data_t, 1> side_data
+) {
+  return av_frame_side_data_name(side_data->handle->type);
+}
+
+static js_arraybuffer_t
+bare_ffmpeg_frame_side_data_get_data(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_side_data_t, 1> side_data
+) {
+  js_arraybuffer_t handle;
+  uint8_t *buf;
+  int err = js_create_arraybuffer(env, side_data->handle->size, buf, handle);
+  assert(err == 0);
+
+  memcpy(buf, side_data->handle->data, side_data->handle->size);
+
+  return handle;
+}
+
+static void
+bare_ffmpeg_frame_transfer_data(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> dst,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> src
+) {
+  int err = av_hwframe_transfer_data(dst->handle, src->handle, 0);
+
+  if (err < 0) {
+    err = js_throw_error(env, NULL, av_err2str(err));
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  bare_ffmpeg__frame_sync(dst->handle, dst->header);
+}
+
+static void
+bare_ffmpeg_frame_map(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> dst,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> src,
+  int32_t flags
+) {
+  int err = av_hwframe_map(dst->handle, src->handle, flags);
+
+  if (err < 0) {
+    err = js_throw_error(env, NULL, av_err2str(err));
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  bare_ffmpeg__frame_sync(dst->handle, dst->header);
+}
+
+static std::optional<js_arraybuffer_t>
+bare_ffmpeg_frame_get_hw_frames_ctx(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame
+) {
+  int err;
+
+  if (frame->handle->hw_frames_ctx == nullptr) {
+    return std::nullopt;
+  }
+
+  js_arraybuffer_t handle;
+  bare_ffmpeg_hw_frames_context_t *hw_frames_ctx;
+  err = js_create_arraybuffer(env, hw_frames_ctx, handle);
+  assert(err == 0);
+
+  hw_frames_ctx->handle = av_buffer_ref(frame->handle->hw_frames_ctx);
+
+  return handle;
+}
+
+static void
+bare_ffmpeg_frame_set_side_data(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame,
+  std::vector<js_object_t> side_data_array
+) {
+  for (js_object_t side_data : side_data_array) {
+    int err;
+
+    int32_t type;
+    err = js_get_property(env, side_data, "type", type);
+    assert(err == 0);
+
+    js_arraybuffer_span_t buf;
+    err = js_get_property(env, side_data, "buffer", buf);
+    assert(err == 0);
+
+    int32_t offset;
+    err = js_get_property(env, side_data, "offset", offset);
+    assert(err == 0);
+
+    int32_t len;
+    err = js_get_property(env, side_data, "length", len);
+    assert(err == 0);
+
+    AVFrameSideData *sd = av_frame_new_side_data(
+      frame->handle,
+      static_cast<AVFrameSideDataType>(type),
+      static_cast<size_t>(len)
+    );
+
+    if (!sd) {
+      err = js_throw_error(env, NULL, "unable to allocate frame side data");
+      assert(err == 0);
+      throw js_pending_exception;
+    }
+
+    if (len > 0) {
+      memcpy(sd->data, &buf[static_cast<size_t>(offset)], static_cast<size_t>(len));
+    }
+  }
+}
+
+static void
+bare_ffmpeg_frame_remove_side_data(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame,
+  int32_t type
+) {
+  av_frame_remove_side_data(
+    frame->handle,
+    static_cast<AVFrameSideDataType>(type)
+  );
+}
+
+static void
+bare_ffmpeg_frame_set_hw_frames_ctx(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame,
+  js_arraybuffer_span_of_t<bare_ffmpeg_hw_frames_context_t, 1> hw_frames_ctx
+) {
+  if (frame->handle->hw_frames_ctx != nullptr) {
+    av_buffer_unref(&frame->handle->hw_frames_ctx);
+  }
+
+  frame->handle->hw_frames_ctx = av_buffer_ref(hw_frames_ctx->handle);
+}
+
+static bool
+bare_ffmpeg_codec_context_open_with_options(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
+  js_arraybuffer_span_of_t<bare_ffmpeg_dictionary_t, 1> options
+) {
+  int err;
+
+  err = avcodec_open2(context->handle, context->handle->codec, &options->handle);
+  if (err < 0) {
+    err = js_throw_error(env, NULL, av_err2str(err));
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  return err == 0;
+}
+
+static int64_t
+bare_ffmpeg_codec_context_get_pixel_format(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
+) {
+  return context->handle->pix_fmt;
+}
+
+static void
+bare_ffmpeg_codec_context_set_pixel_format(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
+  int32_t value
+) {
+  context->handle->pix_fmt = static_cast<AVPixelFormat>(value);
+}
+
+static int64_t
+bare_ffmpeg_codec_context_get_width(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
+) {
+  return context->handle->width;
+}
+
+static void
+bare_ffmpeg_codec_context_set_width(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
+  int value
+) {
+  context->handle->width = value;
+}
+
+static int64_t
+bare_ffmpeg_codec_context_get_height(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
+) {
+  return context->handle->height;
+}
+
+static void
+bare_ffmpeg_codec_context_set_height(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
+  int value
+) {
+  context->handle->height = value;
+}
+
+static int64_t
+bare_ffmpeg_codec_context_get_sample_format(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
+) {
+  return context->handle->sample_fmt;
+}
+
+static void
+bare_ffmpeg_codec_context_set_sample_format(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
+  int32_t value
+) {
+  context->handle->sample_fmt = static_cast<AVSampleFormat>(value);
+}
+
+static js_arraybuffer_t
+bare_ffmpeg_codec_context_get_time_base(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
+) {
+  int err;
+
+  js_arraybuffer_t result;
+
+  int32_t *data;
+  err = js_create_arraybuffer(env, 2, data, result);
+  assert(err == 0);
+
+  data[0] = context->handle->time_base.num;
+  data[1] = context->handle->time_base.den;
+
+  return result;
+}
+
+static void
+bare_ffmpeg_codec_context_set_time_base(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
+  int num,
+  int den
+) {
+  context->handle->time_base.num = num;
+  context->handle->time_base.den = den;
+}
+
+static js_arraybuffer_t
+bare_ffmpeg_codec_context_get_channel_layout(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
+) {
+  int err;
+
+  js_arraybuffer_t result;
+
+  bare_ffmpeg_channel_layout_t *layout;
+  err = js_create_arraybuffer(env, layout, result);
+  assert(err == 0);
+
+  err = av_channel_layout_copy(&layout->handle, &context->handle->ch_layout);
+  assert(err == 0);
+
+  return result;
+}
+
+static void
+bare_ffmpeg_codec_context_set_channel_layout(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
+  js_arraybuffer_span_of_t<bare_ffmpeg_channel_layout_t, 1> layout
+) {
+  int err;
+
+  err = av_channel_layout_copy(&context->handle->ch_layout, &layout->handle);
+  assert(err == 0);
+}
+
+static int
+bare_ffmpeg_codec_context_get_sample_rate(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
+) {
+  return context->handle->sample_rate;
+}
+
+static void
+bare_ffmpeg_codec_context_set_sample_rate(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
+  int32_t sample_rate
+) {
+  context->handle->sample_rate = sample_rate;
+}
+
+static int
+bare_ffmpeg_codec_context_get_gop_size(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
+) {
   return context->handle->gop_size;
 }
 
 static void
-bare_ffmpeg_codec_context_set_gop_size(
+bare_ffmpeg_codec_context_set_gop_size(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
+  int32_t gop_size
+) {
+  context->handle->gop_size = gop_size;
+}
+
+static int
+bare_ffmpeg_codec_context_get_frame_size(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
+) {
+  return context->handle->frame_size;
+}
+
+static int64_t
+bare_ffmpeg_codec_context_get_frame_num(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
+) {
+  return context->handle->frame_num;
+}
+
+static js_arraybuffer_t
+bare_ffmpeg_codec_context_get_framerate(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
+) {
+  int err;
+
+  js_arraybuffer_t result;
+
+  int32_t *data;
+  err = js_create_arraybuffer(env, 2, data, result);
+  assert(err == 0);
+
+  data[0] = context->handle->framerate.num;
+  data[1] = context->handle->framerate.den;
+
+  return result;
+}
+
+static void
+bare_ffmpeg_codec_context_set_framerate(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
+  int num,
+  int den
+) {
+  context->handle->framerate.num = num;
+  context->handle->framerate.den = den;
+}
+
+static void
+bare_ffmpeg_codec_context_flush(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
+) {
+  avcodec_flush_buffers(context->handle);
+}
+
+static bool
+bare_ffmpeg_codec_context_send_packet(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
+  js_arraybuffer_span_of_t<bare_ffmpeg_packet_t, 1> packet
+) {
+  int err;
+
+  err = avcodec_send_packet(context->handle, packet->handle);
+  if (err < 0 && err != AVERROR(EAGAIN) && err != AVERROR_EOF) {
+    err = js_throw_error(env, NULL, av_err2str(err));
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  return err == 0;
+}
+
+static int64_t
+bare_ffmpeg_codec_context_get_request_sample_format(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
+) {
+  return context->handle->request_sample_fmt;
+}
+
+static void
+bare_ffmpeg_codec_context_set_request_sample_format(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
+  int64_t sample_format
+) {
+  context->handle->request_sample_fmt = static_cast<AVSampleFormat>(sample_format);
+}
+
+static std::optional<js_arraybuffer_t>
+bare_ffmpeg_codec_context_get_hw_device_ctx(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
+) {
+  int err;
+
+  if (context->handle->hw_device_ctx == nullptr) {
+    return std::nullopt;
+  }
+
+  js_arraybuffer_t handle;
+  bare_ffmpeg_hw_device_context_t *hw_device_ctx;
+  err = js_create_arraybuffer(env, hw_device_ctx, handle);
+  assert(err == 0);
+
+  hw_device_ctx->handle = av_buffer_ref(context->handle->hw_device_ctx);
+
+  return handle;
+}
+
+static void
+bare_ffmpeg_codec_context_set_hw_device_ctx(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
+  js_arraybuffer_span_of_t<bare_ffmpeg_hw_device_context_t, 1> hw_device_ctx
+) {
+  if (context->handle->hw_device_ctx != nullptr) {
+    av_buffer_unref(&context->handle->hw_device_ctx);
+  }
+
+  context->handle->hw_device_ctx = av_buffer_ref(hw_device_ctx->handle);
+}
+
+static enum AVPixelFormat
+bare_ffmpeg__on_codec_context_get_format(struct AVCodecContext *input_context, const enum AVPixelFormat *fmt) {
+  int err;
+
+  auto context = static_cast<bare_ffmpeg_codec_context_t *>(input_context->opaque);
+
+  assert(context->env);
+  assert(context->get_format_cb);
+
+  bare_ffmpeg_codec_context_get_format_cb_t callback;
+  err = js_get_reference_value(context->env, context->get_format_cb, callback);
+  assert(err == 0);
+
+  std::vector<int> formats{};
+  for (const enum AVPixelFormat *p = fmt; *p != AV_PIX_FMT_NONE; ++p) {
+    formats.push_back(static_cast<int>(*p));
+  }
+
+  int result;
+  err = js_call_function<js_type_options_t{}, int, std::vector<int>>(
+    context->env,
+    callback,
+    formats,
+    result
+  );
+  assert(err == 0);
+
+  return static_cast<enum AVPixelFormat>(result);
+}
+
+static int
+bare_ffmpeg__on_codec_context_get_buffer(struct AVCodecContext *input_context, AVFrame *frame, int flags) {
+  int err;
+
+  auto context = static_cast<bare_ffmpeg_codec_context_t *>(input_context->opaque);
+  auto pool = context->buffer_pool;
+
+  auto format = static_cast<AVPixelFormat>(frame->format);
+  auto desc = av_pix_fmt_desc_get(format);
+
+  if (input_context->codec_type != AVMEDIA_TYPE_VIDEO || desc == NULL || (desc->flags & AV_PIX_FMT_FLAG_HWACCEL)) {
+    return avcodec_default_get_buffer2(input_context, frame, flags);
+  }
+
+  // With frame threading this may run on a codec thread, but never on more
+  // than one thread at a time, so the pool state needs no locking
+  if (pool->format != frame->format || pool->width != frame->width || pool->height != frame->height) {
+    int width = frame->width;
+    int height = frame->height;
+
+    int linesize_align[AV_NUM_DATA_POINTERS];
+    avcodec_align_dimensions2(input_context, &width, &height, linesize_align);
+
+    err = av_image_fill_linesizes(pool->linesize, format, FFALIGN(width, pool->align));
+    if (err < 0) return err;
+
+    ptrdiff_t linesize[4];
+
+    for (int i = 0; i < 4; i++) {
+      // Honour the stride the decoder requires for its SIMD routines as well
+      // as the alignment requested for the pool
+      pool->linesize[i] = FFALIGN(pool->linesize[i], FFMAX(pool->align, linesize_align[i]));
+
+      linesize[i] = pool->linesize[i];
+    }
+
+    err = av_image_fill_plane_sizes(pool->sizes, format, height, linesize);
+    if (err < 0) return err;
+
+    for (int i = 0; i < 4; i++) {
+      av_buffer_pool_uninit(&pool->pools[i]);
+
+      // Leave room for decoders that read slightly past the end of a plane
+      if (pool->sizes[i] > 0) {
+        pool->pools[i] = av_buffer_pool_init(pool->sizes[i] + 16 + pool->align - 1, NULL);
+
+        if (pool->pools[i] == NULL) {
+          pool->format = AV_PIX_FMT_NONE;
+
+          return AVERROR(ENOMEM);
+        }
+      }
+    }
+
+    pool->format = frame->format;
+    pool->width = frame->width;
+    pool->height = frame->height;
+  }
+
+  for (int i = 0; i < 4; i++) {
+    if (pool->pools[i] == NULL) continue;
+
+    frame->buf[i] = av_buffer_pool_get(pool->pools[i]);
+
+    if (frame->buf[i] == NULL) {
+      av_frame_unref(frame);
+
+      return AVERROR(ENOMEM);
+    }
+
+    // The buffers are over-allocated by the alignment, so the plane can start
+    // on the next aligned address
+    frame->data[i] = reinterpret_cast<uint8_t *>(FFALIGN(reinterpret_cast<uintptr_t>(frame->buf[i]->data), pool->align));
+    frame->linesize[i] = pool->linesize[i];
+  }
+
+  frame->extended_data = frame->data;
+
+  return 0;
+}
+
+static void
+bare_ffmpeg_codec_context_set_buffer_pool(
   js_env_t *env,
   js_receiver_t,
   js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
-  int32_t gop_size
+  int32_t align
 ) {
-  context->handle->gop_size = gop_size;
-}
+  if (context->buffer_pool == NULL) {
+    context->buffer_pool = new bare_ffmpeg_codec_context_buffer_pool_t();
+  }
 
-static int
-bare_ffmpeg_codec_context_get_frame_size(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
-) {
-  return context->handle->frame_size;
+  context->buffer_pool->align = align;
+  context->buffer_pool->format = AV_PIX_FMT_NONE;
+
+  context->handle->get_buffer2 = bare_ffmpeg__on_codec_context_get_buffer;
 }
 
-static int64_t
-bare_ffmpeg_codec_context_get_frame_num(
+static void
+bare_ffmpeg_codec_context_set_get_format(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
+  bare_ffmpeg_codec_context_get_format_cb_t callback
 ) {
-  return context->handle->frame_num;
+  int err = js_create_reference(env, callback, context->get_format_cb);
+  assert(err == 0);
+
+  context->handle->get_format = bare_ffmpeg__on_codec_context_get_format;
+  context->env = env;
 }
 
-static js_arraybuffer_t
-bare_ffmpeg_codec_context_get_framerate(
+static bool
+bare_ffmpeg_codec_context_receive_packet(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
+  js_arraybuffer_span_of_t<bare_ffmpeg_packet_t, 1> packet
 ) {
   int err;
 
-  js_arraybuffer_t result;
+  err = avcodec_receive_packet(context->handle, packet->handle);
+  if (err < 0 && err != AVERROR(EAGAIN) && err != AVERROR_EOF) {
+    err = js_throw_error(env, NULL, av_err2str(err));
+    assert(err == 0);
 
-  int32_t *data;
-  err = js_create_arraybuffer(env, 2, data, result);
-  assert(err == 0);
+    throw js_pending_exception;
+  }
 
-  data[0] = context->handle->framerate.num;
-  data[1] = context->handle->framerate.den;
+  bare_ffmpeg__packet_sync(packet->handle, packet->header);
 
-  return result;
+  return err == 0;
 }
 
-static void
-bare_ffmpeg_codec_context_set_framerate(
+static bool
+bare_ffmpeg_codec_context_send_frame(
   js_env_t *env,
   js_receiver_t,
   js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
-  int num,
-  int den
+  std::optional<js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1>> frame
 ) {
-  context->handle->framerate.num = num;
-  context->handle->framerate.den = den;
+  int err;
+
+  if (frame) {
+    err = avcodec_send_frame(context->handle, frame.value()->handle);
+  } else {
+    err = avcodec_send_frame(context->handle, NULL); // End of stream
+  }
+
+  if (err < 0 && err != AVERROR(EAGAIN) && err != AVERROR_EOF) {
+    err = js_throw_error(env, NULL, av_err2str(err));
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  return err == 0;
 }
 
 static bool
-bare_ffmpeg_codec_context_send_packet(
+bare_ffmpeg_codec_context_receive_frame(
   js_env_t *env,
   js_receiver_t,
   js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
-  js_arraybuffer_span_of_t<bare_ffmpeg_packet_t, 1> packet
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame
 ) {
   int err;
 
-  err = avcodec_send_packet(context->handle, packet->handle);
+  err = avcodec_receive_frame(context->handle, frame->handle);
   if (err < 0 && err != AVERROR(EAGAIN) && err != AVERROR_EOF) {
     err = js_throw_error(env, NULL, av_err2str(err));
     assert(err == 0);
@@ -1913,171 +4342,431 @@ bare_ffmpeg_codec_context_send_packet(
     throw js_pending_exception;
   }
 
+  bare_ffmpeg__frame_sync(frame->handle, frame->header);
+
   return err == 0;
 }
 
-static int64_t
-bare_ffmpeg_codec_context_get_request_sample_format(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
-) {
-  return context->handle->request_sample_fmt;
+static bare_ffmpeg_codec_context_job_t *
+bare_ffmpeg__codec_context_job_init(js_env_t *env, js_arraybuffer_t handle) {
+  int err;
+
+  std::span<uint8_t> view;
+  err = js_get_arraybuffer_info(env, handle, view);
+  assert(err == 0);
+
+  auto owner = reinterpret_cast<bare_ffmpeg_codec_context_t *>(view.data());
+
+  auto context = owner->handle;
+
+  if (context->get_format == bare_ffmpeg__on_codec_context_get_format) {
+    err = js_throw_error(env, NULL, "Asynchronous operations are not supported with a getFormat callback");
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  auto job = new bare_ffmpeg_codec_context_job_t();
+
+  job->env = env;
+  job->owner = owner;
+  job->context = context;
+
+  err = js_create_reference(env, handle, job->context_ref);
+  assert(err == 0);
+
+  return job;
 }
 
 static void
-bare_ffmpeg_codec_context_set_request_sample_format(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
-  int64_t sample_format
-) {
-  context->handle->request_sample_fmt = static_cast<AVSampleFormat>(sample_format);
+bare_ffmpeg__codec_context_job_destroy(bare_ffmpeg_codec_context_job_t *job) {
+  job->context_ref.reset();
+  job->on_complete.reset();
+  job->on_encode.reset();
+  job->target_ref.reset();
+
+  for (auto packet : job->packets) {
+    av_packet_free(&packet);
+  }
+
+  av_packet_free(&job->packet);
+  av_frame_free(&job->frame);
+
+  delete job;
 }
 
-static std::optional<js_arraybuffer_t>
-bare_ffmpeg_codec_context_get_hw_device_ctx(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context
-) {
+static void
+bare_ffmpeg__codec_context_job_start(bare_ffmpeg_codec_context_job_t *job) {
+  int err;
+
+  uv_loop_t *loop;
+  err = js_get_env_loop(job->env, &loop);
+  assert(err == 0);
+
+  err = uv_queue_work(loop, &job->handle, job->work, job->done);
+  assert(err == 0);
+}
+
+static void
+bare_ffmpeg__codec_context_job_queue(js_env_t *env, bare_ffmpeg_codec_context_job_t *job, uv_work_cb work, uv_after_work_cb done) {
+  auto owner = job->owner;
+
+  job->work = work;
+  job->done = done;
+
+  if (owner->queue_tail) {
+    owner->queue_tail->next = job;
+    owner->queue_tail = job;
+  } else {
+    owner->queue_head = owner->queue_tail = job;
+
+    bare_ffmpeg__codec_context_job_start(job);
+  }
+}
+
+static void
+bare_ffmpeg__codec_context_job_dequeue(bare_ffmpeg_codec_context_job_t *job) {
+  auto owner = job->owner;
+
+  assert(owner->queue_head == job);
+
+  owner->queue_head = job->next;
+
+  if (owner->queue_head) bare_ffmpeg__codec_context_job_start(owner->queue_head);
+  else owner->queue_tail = NULL;
+}
+
+static void
+bare_ffmpeg__on_codec_context_job_done(uv_work_t *handle, int status) {
+  int err;
+
+  auto job = reinterpret_cast<bare_ffmpeg_codec_context_job_t *>(handle);
+
+  auto env = job->env;
+
+  js_handle_scope_t *scope;
+  err = js_open_handle_scope(env, &scope);
+  assert(err == 0);
+
+  int32_t result = job->status;
+
+  if (result == 0) {
+    if (job->target_frame && job->target_frame->handle) {
+      av_frame_unref(job->target_frame->handle);
+      av_frame_move_ref(job->target_frame->handle, job->frame);
+
+      bare_ffmpeg__frame_sync(job->target_frame->handle, job->target_frame->header);
+    }
+
+    if (job->target_packet && job->target_packet->handle) {
+      av_packet_unref(job->target_packet->handle);
+      av_packet_move_ref(job->target_packet->handle, job->packet);
+
+      bare_ffmpeg__packet_sync(job->target_packet->handle, job->target_packet->header);
+    }
+
+    result = 1;
+  } else if (result == AVERROR(EAGAIN) || result == AVERROR_EOF) {
+    result = 0;
+  }
+
+  bare_ffmpeg_codec_context_job_cb_t callback;
+  err = js_get_reference_value(env, job->on_complete, callback);
+  assert(err == 0);
+
+  bare_ffmpeg__codec_context_job_dequeue(job);
+  bare_ffmpeg__codec_context_job_destroy(job);
+
+  err = js_call_function(env, callback, result);
+  assert(err == 0);
+
+  err = js_close_handle_scope(env, scope);
+  assert(err == 0);
+}
+
+static void
+bare_ffmpeg__on_codec_context_encode_done(uv_work_t *handle, int status) {
+  int err;
+
+  auto job = reinterpret_cast<bare_ffmpeg_codec_context_job_t *>(handle);
+
+  auto env = job->env;
+
+  js_handle_scope_t *scope;
+  err = js_open_handle_scope(env, &scope);
+  assert(err == 0);
+
+  int32_t result = job->status;
+
+  std::vector<js_arraybuffer_t> packets;
+
+  // Packets drained before a failure are handed over along with the error
+  for (auto &packet : job->packets) {
+    js_arraybuffer_t handle;
+
+    bare_ffmpeg_packet_t *target;
+    err = js_create_arraybuffer(env, target, handle);
+    assert(err == 0);
+
+    target->handle = packet;
+
+    bare_ffmpeg__packet_sync(target->handle, target->header);
+
+    packet = NULL;
+
+    packets.push_back(handle);
+  }
+
+  if (result >= 0 || result == AVERROR(EAGAIN) || result == AVERROR_EOF) {
+    result = result == 0 ? 1 : 0;
+  }
+
+  bare_ffmpeg_codec_context_encode_cb_t callback;
+  err = js_get_reference_value(env, job->on_encode, callback);
+  assert(err == 0);
+
+  bare_ffmpeg__codec_context_job_dequeue(job);
+  bare_ffmpeg__codec_context_job_destroy(job);
+
+  err = js_call_function(env, callback, result, packets);
+  assert(err == 0);
+
+  err = js_close_handle_scope(env, scope);
+  assert(err == 0);
+}
+
+static void
+bare_ffmpeg__on_codec_context_send_packet(uv_work_t *handle) {
+  auto job = reinterpret_cast<bare_ffmpeg_codec_context_job_t *>(handle);
+
+  job->status = avcodec_send_packet(job->context, job->packet);
+}
+
+static void
+bare_ffmpeg__on_codec_context_receive_frame(uv_work_t *handle) {
+  auto job = reinterpret_cast<bare_ffmpeg_codec_context_job_t *>(handle);
+
+  job->status = avcodec_receive_frame(job->context, job->frame);
+}
+
+static void
+bare_ffmpeg__on_codec_context_send_frame(uv_work_t *handle) {
+  auto job = reinterpret_cast<bare_ffmpeg_codec_context_job_t *>(handle);
+
+  job->status = avcodec_send_frame(job->context, job->frame);
+}
+
+static void
+bare_ffmpeg__on_codec_context_receive_packet(uv_work_t *handle) {
+  auto job = reinterpret_cast<bare_ffmpeg_codec_context_job_t *>(handle);
+
+  job->status = avcodec_receive_packet(job->context, job->packet);
+}
+
+static int
+bare_ffmpeg__codec_context_job_drain(bare_ffmpeg_codec_context_job_t *job) {
+  int err;
+
+  while (true) {
+    auto packet = av_packet_alloc();
+
+    err = avcodec_receive_packet(job->context, packet);
+    if (err < 0) {
+      av_packet_free(&packet);
+
+      return err == AVERROR(EAGAIN) || err == AVERROR_EOF ? 0 : err;
+    }
+
+    job->packets.push_back(packet);
+  }
+}
+
+static void
+bare_ffmpeg__on_codec_context_encode(uv_work_t *handle) {
   int err;
 
-  if (context->handle->hw_device_ctx == nullptr) {
-    return std::nullopt;
-  }
+  auto job = reinterpret_cast<bare_ffmpeg_codec_context_job_t *>(handle);
 
-  js_arraybuffer_t handle;
-  bare_ffmpeg_hw_device_context_t *hw_device_ctx;
-  err = js_create_arraybuffer(env, hw_device_ctx, handle);
-  assert(err == 0);
+  job->status = avcodec_send_frame(job->context, job->frame);
 
-  hw_device_ctx->handle = av_buffer_ref(context->handle->hw_device_ctx);
+  // The encoder is full, so make room by draining it before retrying.
+  if (job->status == AVERROR(EAGAIN)) {
+    err = bare_ffmpeg__codec_context_job_drain(job);
+    if (err < 0) {
+      job->status = err;
+      return;
+    }
 
-  return handle;
+    job->status = avcodec_send_frame(job->context, job->frame);
+  }
+
+  if (job->status < 0 && job->status != AVERROR_EOF) return;
+
+  err = bare_ffmpeg__codec_context_job_drain(job);
+  if (err < 0) job->status = err;
 }
 
 static void
-bare_ffmpeg_codec_context_set_hw_device_ctx(
+bare_ffmpeg_codec_context_send_packet_async(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
-  js_arraybuffer_span_of_t<bare_ffmpeg_hw_device_context_t, 1> hw_device_ctx
+  js_arraybuffer_t context,
+  std::optional<js_arraybuffer_span_of_t<bare_ffmpeg_packet_t, 1>> packet,
+  bare_ffmpeg_codec_context_job_cb_t callback
 ) {
-  if (context->handle->hw_device_ctx != nullptr) {
-    av_buffer_unref(&context->handle->hw_device_ctx);
-  }
+  int err;
 
-  context->handle->hw_device_ctx = av_buffer_ref(hw_device_ctx->handle);
-}
+  auto job = bare_ffmpeg__codec_context_job_init(env, context);
 
-static enum AVPixelFormat
-bare_ffmpeg__on_codec_context_get_format(struct AVCodecContext *input_context, const enum AVPixelFormat *fmt) {
-  int err;
+  err = js_create_reference(env, callback, job->on_complete);
+  assert(err == 0);
 
-  auto context = static_cast<bare_ffmpeg_codec_context_t *>(input_context->opaque);
+  // Hold a reference to the packet so the caller is free to reuse it while
+  // the worker is decoding.
+  if (packet) {
+    job->packet = av_packet_alloc();
 
-  assert(context->env);
-  assert(context->get_format_cb);
+    err = av_packet_ref(job->packet, packet.value()->handle);
+    if (err < 0) {
+      bare_ffmpeg__codec_context_job_destroy(job);
 
-  bare_ffmpeg_codec_context_get_format_cb_t callback;
-  err = js_get_reference_value(context->env, context->get_format_cb, callback);
-  assert(err == 0);
+      err = js_throw_error(env, NULL, av_err2str(err));
+      assert(err == 0);
 
-  std::vector<int> formats{};
-  for (const enum AVPixelFormat *p = fmt; *p != AV_PIX_FMT_NONE; ++p) {
-    formats.push_back(static_cast<int>(*p));
+      throw js_pending_exception;
+    }
   }
 
-  int result;
-  err = js_call_function<js_type_options_t{}, int, std::vector<int>>(
-    context->env,
-    callback,
-    formats,
-    result
-  );
-  assert(err == 0);
-
-  return static_cast<enum AVPixelFormat>(result);
+  bare_ffmpeg__codec_context_job_queue(env, job, bare_ffmpeg__on_codec_context_send_packet, bare_ffmpeg__on_codec_context_job_done);
 }
 
 static void
-bare_ffmpeg_codec_context_set_get_format(
+bare_ffmpeg_codec_context_receive_frame_async(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
-  bare_ffmpeg_codec_context_get_format_cb_t callback
+  js_arraybuffer_t context,
+  js_arraybuffer_t frame,
+  bare_ffmpeg_codec_context_job_cb_t callback
 ) {
-  int err = js_create_reference(env, callback, context->get_format_cb);
+  int err;
+
+  std::span<uint8_t> view;
+  err = js_get_arraybuffer_info(env, frame, view);
   assert(err == 0);
 
-  context->handle->get_format = bare_ffmpeg__on_codec_context_get_format;
-  context->env = env;
+  auto job = bare_ffmpeg__codec_context_job_init(env, context);
+
+  err = js_create_reference(env, callback, job->on_complete);
+  assert(err == 0);
+
+  // Decode into a private frame and move it into the target on completion so
+  // the target is never touched from the worker.
+  job->frame = av_frame_alloc();
+  job->target_frame = reinterpret_cast<bare_ffmpeg_frame_t *>(view.data());
+
+  err = js_create_reference(env, frame, job->target_ref);
+  assert(err == 0);
+
+  bare_ffmpeg__codec_context_job_queue(env, job, bare_ffmpeg__on_codec_context_receive_frame, bare_ffmpeg__on_codec_context_job_done);
 }
 
-static bool
-bare_ffmpeg_codec_context_receive_packet(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
-  js_arraybuffer_span_of_t<bare_ffmpeg_packet_t, 1> packet
-) {
+static AVFrame *
+bare_ffmpeg__codec_context_job_ref_frame(js_env_t *env, bare_ffmpeg_codec_context_job_t *job, AVFrame *frame) {
   int err;
 
-  err = avcodec_receive_packet(context->handle, packet->handle);
-  if (err < 0 && err != AVERROR(EAGAIN) && err != AVERROR_EOF) {
+  auto clone = av_frame_alloc();
+
+  // The worker only takes a reference to the frame buffers, so copying data
+  // never happens on the JavaScript thread. Properties are copied, letting
+  // the caller reuse the frame itself once its buffers are replaced.
+  err = av_frame_ref(clone, frame);
+
+  if (err < 0) {
+    av_frame_free(&clone);
+
+    bare_ffmpeg__codec_context_job_destroy(job);
+
     err = js_throw_error(env, NULL, av_err2str(err));
     assert(err == 0);
 
     throw js_pending_exception;
   }
 
-  return err == 0;
+  return clone;
 }
 
-static bool
-bare_ffmpeg_codec_context_send_frame(
+static void
+bare_ffmpeg_codec_context_send_frame_async(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
-  std::optional<js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1>> frame
+  js_arraybuffer_t context,
+  std::optional<js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1>> frame,
+  bare_ffmpeg_codec_context_job_cb_t callback
 ) {
   int err;
 
+  auto job = bare_ffmpeg__codec_context_job_init(env, context);
+
+  err = js_create_reference(env, callback, job->on_complete);
+  assert(err == 0);
+
+  // Hold a reference to the frame so the caller is free to reuse it while
+  // the worker is encoding.
   if (frame) {
-    err = avcodec_send_frame(context->handle, frame.value()->handle);
-  } else {
-    err = avcodec_send_frame(context->handle, NULL); // End of stream
+    job->frame = bare_ffmpeg__codec_context_job_ref_frame(env, job, frame.value()->handle);
   }
 
-  if (err < 0 && err != AVERROR(EAGAIN) && err != AVERROR_EOF) {
-    err = js_throw_error(env, NULL, av_err2str(err));
-    assert(err == 0);
+  bare_ffmpeg__codec_context_job_queue(env, job, bare_ffmpeg__on_codec_context_send_frame, bare_ffmpeg__on_codec_context_job_done);
+}
 
-    throw js_pending_exception;
-  }
+static void
+bare_ffmpeg_codec_context_receive_packet_async(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_t context,
+  js_arraybuffer_t packet,
+  bare_ffmpeg_codec_context_job_cb_t callback
+) {
+  int err;
 
-  return err == 0;
+  std::span<uint8_t> view;
+  err = js_get_arraybuffer_info(env, packet, view);
+  assert(err == 0);
+
+  auto job = bare_ffmpeg__codec_context_job_init(env, context);
+
+  err = js_create_reference(env, callback, job->on_complete);
+  assert(err == 0);
+
+  job->packet = av_packet_alloc();
+  job->target_packet = reinterpret_cast<bare_ffmpeg_packet_t *>(view.data());
+
+  err = js_create_reference(env, packet, job->target_ref);
+  assert(err == 0);
+
+  bare_ffmpeg__codec_context_job_queue(env, job, bare_ffmpeg__on_codec_context_receive_packet, bare_ffmpeg__on_codec_context_job_done);
 }
 
-static bool
-bare_ffmpeg_codec_context_receive_frame(
+static void
+bare_ffmpeg_codec_context_encode_async(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_codec_context_t, 1> context,
-  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame
+  js_arraybuffer_t context,
+  std::optional<js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1>> frame,
+  bare_ffmpeg_codec_context_encode_cb_t callback
 ) {
   int err;
 
-  err = avcodec_receive_frame(context->handle, frame->handle);
-  if (err < 0 && err != AVERROR(EAGAIN) && err != AVERROR_EOF) {
-    err = js_throw_error(env, NULL, av_err2str(err));
-    assert(err == 0);
+  auto job = bare_ffmpeg__codec_context_job_init(env, context);
 
-    throw js_pending_exception;
+  err = js_create_reference(env, callback, job->on_encode);
+  assert(err == 0);
+
+  if (frame) {
+    job->frame = bare_ffmpeg__codec_context_job_ref_frame(env, job, frame.value()->handle);
   }
 
-  return err == 0;
+  bare_ffmpeg__codec_context_job_queue(env, job, bare_ffmpeg__on_codec_context_encode, bare_ffmpeg__on_codec_context_encode_done);
 }
 
 static void
@@ -2116,6 +4805,24 @@ bare_ffmpeg_codec_parameters_to_context(
   }
 }
 
+static void
+bare_ffmpeg_codec_parameters_copy(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_parameters_t, 1> target,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_parameters_t, 1> source
+) {
+  int err;
+
+  err = avcodec_parameters_copy(target->handle, source->handle);
+  if (err < 0) {
+    err = js_throw_error(env, NULL, av_err2str(err));
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+}
+
 static js_arraybuffer_t
 bare_ffmpeg_codec_parameters_alloc(
   js_env_t *env,
@@ -2826,6 +5533,8 @@ bare_ffmpeg_frame_init(js_env_t *env, js_receiver_t) {
   frame->handle = av_frame_alloc();
   frame->handle->opaque = (void *) frame;
 
+  bare_ffmpeg__frame_sync(frame->handle, frame->header);
+
   return handle;
 }
 
@@ -2836,6 +5545,8 @@ bare_ffmpeg_frame_unref(
   js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame
 ) {
   av_frame_unref(frame->handle);
+
+  bare_ffmpeg__frame_sync(frame->handle, frame->header);
 }
 
 static void
@@ -2864,6 +5575,8 @@ bare_ffmpeg_frame_set_width(
   int32_t width
 ) {
   frame->handle->width = width;
+
+  bare_ffmpeg__frame_sync(frame->handle, frame->header);
 }
 
 static int32_t
@@ -2883,6 +5596,8 @@ bare_ffmpeg_frame_set_height(
   int32_t height
 ) {
   frame->handle->height = height;
+
+  bare_ffmpeg__frame_sync(frame->handle, frame->header);
 }
 
 static int32_t
@@ -2902,6 +5617,8 @@ bare_ffmpeg_frame_set_nb_samples(
   int32_t nb_samples
 ) {
   frame->handle->nb_samples = nb_samples;
+
+  bare_ffmpeg__frame_sync(frame->handle, frame->header);
 }
 
 static int32_t
@@ -2934,6 +5651,8 @@ bare_ffmpeg_frame_set_pts(
   int64_t value
 ) {
   frame->handle->pts = value;
+
+  bare_ffmpeg__frame_sync(frame->handle, frame->header);
 }
 
 static int64_t
@@ -2957,6 +5676,8 @@ bare_ffmpeg_frame_set_pkt_dts(
   int64_t value
 ) {
   frame->handle->pkt_dts = value;
+
+  bare_ffmpeg__frame_sync(frame->handle, frame->header);
 }
 
 static js_arraybuffer_t
@@ -2976,56 +5697,245 @@ bare_ffmpeg_frame_get_time_base(
   data[0] = frame->handle->time_base.num;
   data[1] = frame->handle->time_base.den;
 
-  return result;
-}
+  return result;
+}
+
+static void
+bare_ffmpeg_frame_set_time_base(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame,
+  int num,
+  int den
+) {
+  frame->handle->time_base.num = num;
+  frame->handle->time_base.den = den;
+
+  bare_ffmpeg__frame_sync(frame->handle, frame->header);
+}
+
+static int32_t
+bare_ffmpeg_frame_get_sample_rate(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame
+) {
+  return frame->handle->sample_rate;
+}
+
+static void
+bare_ffmpeg_frame_set_sample_rate(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame,
+  int32_t rate
+) {
+  frame->handle->sample_rate = rate;
+
+  bare_ffmpeg__frame_sync(frame->handle, frame->header);
+}
+
+static void
+bare_ffmpeg_frame_alloc(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame,
+  int align
+) {
+  int err;
+
+  err = av_frame_get_buffer(frame->handle, align);
+  if (err < 0) {
+    err = js_throw_error(env, NULL, av_err2str(err));
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  bare_ffmpeg__frame_sync(frame->handle, frame->header);
+}
+
+static js_arraybuffer_t
+bare_ffmpeg_frame_pool_init_video(
+  js_env_t *env,
+  js_receiver_t,
+  int32_t format,
+  int32_t width,
+  int32_t height,
+  int32_t align
+) {
+  int err;
+
+  auto size = av_image_get_buffer_size(static_cast<AVPixelFormat>(format), width, height, align);
+  if (size < 0) {
+    err = js_throw_error(env, NULL, av_err2str(size));
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  js_arraybuffer_t handle;
+
+  bare_ffmpeg_frame_pool_t *pool;
+  err = js_create_arraybuffer(env, pool, handle);
+  assert(err == 0);
+
+  // Leave the same trailing padding as av_frame_get_buffer() so that
+  // optimised readers may overread the end of the last plane
+  pool->handle = av_buffer_pool_init(size + AV_INPUT_BUFFER_PADDING_SIZE, NULL);
+  if (pool->handle == NULL) {
+    err = js_throw_error(env, NULL, av_err2str(AVERROR(ENOMEM)));
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  pool->format = format;
+  pool->width = width;
+  pool->height = height;
+  pool->nb_samples = 0;
+  pool->align = align;
+  pool->ch_layout = {};
+
+  return handle;
+}
+
+static js_arraybuffer_t
+bare_ffmpeg_frame_pool_init_audio(
+  js_env_t *env,
+  js_receiver_t,
+  int32_t format,
+  js_arraybuffer_span_of_t<bare_ffmpeg_channel_layout_t, 1> layout,
+  int32_t nb_samples,
+  int32_t align
+) {
+  int err;
+
+  auto sample_fmt = static_cast<AVSampleFormat>(format);
+  auto channels = layout->handle.nb_channels;
+
+  if (av_sample_fmt_is_planar(sample_fmt) && channels > AV_NUM_DATA_POINTERS) {
+    err = js_throw_error(env, NULL, "Too many channels for a pooled planar frame");
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  auto size = av_samples_get_buffer_size(NULL, channels, nb_samples, sample_fmt, align);
+  if (size < 0) {
+    err = js_throw_error(env, NULL, av_err2str(size));
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  js_arraybuffer_t handle;
+
+  bare_ffmpeg_frame_pool_t *pool;
+  err = js_create_arraybuffer(env, pool, handle);
+  assert(err == 0);
+
+  pool->handle = av_buffer_pool_init(size + AV_INPUT_BUFFER_PADDING_SIZE, NULL);
+  if (pool->handle == NULL) {
+    err = js_throw_error(env, NULL, av_err2str(AVERROR(ENOMEM)));
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  pool->format = format;
+  pool->width = 0;
+  pool->height = 0;
+  pool->nb_samples = nb_samples;
+  pool->align = align;
+  pool->ch_layout = {};
 
-static void
-bare_ffmpeg_frame_set_time_base(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame,
-  int num,
-  int den
-) {
-  frame->handle->time_base.num = num;
-  frame->handle->time_base.den = den;
-}
+  err = av_channel_layout_copy(&pool->ch_layout, &layout->handle);
+  assert(err == 0);
 
-static int32_t
-bare_ffmpeg_frame_get_sample_rate(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame
-) {
-  return frame->handle->sample_rate;
+  return handle;
 }
 
 static void
-bare_ffmpeg_frame_set_sample_rate(
+bare_ffmpeg_frame_pool_destroy(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame,
-  int32_t rate
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_pool_t, 1> pool
 ) {
-  frame->handle->sample_rate = rate;
+  // Buffers still referenced by frames keep the pool alive until they are
+  // returned, at which point it is freed
+  av_buffer_pool_uninit(&pool->handle);
+  av_channel_layout_uninit(&pool->ch_layout);
 }
 
 static void
-bare_ffmpeg_frame_alloc(
+bare_ffmpeg_frame_pool_get(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame,
-  int align
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_pool_t, 1> pool,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame
 ) {
   int err;
 
-  err = av_frame_get_buffer(frame->handle, align);
+  auto target = frame->handle;
+
+  av_frame_unref(target);
+
+  auto buf = av_buffer_pool_get(pool->handle);
+  if (buf == NULL) {
+    err = js_throw_error(env, NULL, av_err2str(AVERROR(ENOMEM)));
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  target->buf[0] = buf;
+  target->format = pool->format;
+
+  if (pool->nb_samples == 0) {
+    target->width = pool->width;
+    target->height = pool->height;
+
+    err = av_image_fill_arrays(
+      target->data,
+      target->linesize,
+      buf->data,
+      static_cast<AVPixelFormat>(pool->format),
+      pool->width,
+      pool->height,
+      pool->align
+    );
+  } else {
+    target->nb_samples = pool->nb_samples;
+
+    err = av_channel_layout_copy(&target->ch_layout, &pool->ch_layout);
+    assert(err == 0);
+
+    err = av_samples_fill_arrays(
+      target->data,
+      &target->linesize[0],
+      buf->data,
+      pool->ch_layout.nb_channels,
+      pool->nb_samples,
+      static_cast<AVSampleFormat>(pool->format),
+      pool->align
+    );
+  }
+
+  target->extended_data = target->data;
+
   if (err < 0) {
+    av_frame_unref(target);
+
+    bare_ffmpeg__frame_sync(target, frame->header);
+
     err = js_throw_error(env, NULL, av_err2str(err));
     assert(err == 0);
 
     throw js_pending_exception;
   }
+
+  bare_ffmpeg__frame_sync(target, frame->header);
 }
 
 static js_arraybuffer_t
@@ -3138,6 +6048,8 @@ bare_ffmpeg_hw_frames_context_get_buffer(
 
     throw js_pending_exception;
   }
+
+  bare_ffmpeg__frame_sync(frame->handle, frame->header);
 }
 
 static js_arraybuffer_t
@@ -3414,6 +6326,8 @@ bare_ffmpeg_image_fill(
 
     throw js_pending_exception;
   }
+
+  bare_ffmpeg__frame_sync(frame->handle, frame->header);
 }
 
 static void
@@ -3529,6 +6443,8 @@ bare_ffmpeg_samples_fill(
     throw js_pending_exception;
   }
 
+  bare_ffmpeg__frame_sync(frame->handle, frame->header);
+
   return res;
 }
 
@@ -3619,9 +6535,69 @@ bare_ffmpeg_packet_init(js_env_t *env, js_receiver_t) {
 
   packet->handle = av_packet_alloc();
 
+  bare_ffmpeg__packet_sync(packet->handle, packet->header);
+
   return handle;
 }
 
+static void
+bare_ffmpeg__packet_wrap(js_env_t *env, AVPacket *packet, js_arraybuffer_t buffer, size_t offset, size_t len) {
+  int err;
+
+  std::span<uint8_t> view;
+  err = js_get_arraybuffer_info(env, buffer, view);
+  assert(err == 0);
+
+  assert(offset + len <= view.size());
+
+  av_packet_unref(packet);
+
+  // Decoders may read up to AV_INPUT_BUFFER_PADDING_SIZE bytes past the end of
+  // the payload and expect them to be zero, so only wrap views followed by
+  // that much zeroed slack.
+  static const uint8_t padding[AV_INPUT_BUFFER_PADDING_SIZE] = {0};
+
+  if (
+    offset + len + AV_INPUT_BUFFER_PADDING_SIZE <= view.size() &&
+    memcmp(&view[offset + len], padding, AV_INPUT_BUFFER_PADDING_SIZE) == 0
+  ) {
+    // The memory belongs to JavaScript, so FFmpeg must copy it before writing
+    auto buf = bare_ffmpeg__pin_create(env, buffer, &view[offset], len + AV_INPUT_BUFFER_PADDING_SIZE, AV_BUFFER_FLAG_READONLY);
+
+    if (buf) {
+      packet->buf = buf;
+      packet->data = buf->data;
+      packet->size = static_cast<int>(len);
+
+      return;
+    }
+  }
+
+  err = av_new_packet(packet, static_cast<int>(len));
+  if (err < 0) {
+    err = js_throw_error(env, NULL, av_err2str(err));
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  memcpy(packet->data, &view[offset], len);
+}
+
+static void
+bare_ffmpeg_packet_wrap(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_packet_t, 1> packet,
+  js_arraybuffer_t buffer,
+  uint64_t offset,
+  uint64_t len
+) {
+  bare_ffmpeg__packet_wrap(env, packet->handle, buffer, static_cast<size_t>(offset), static_cast<size_t>(len));
+
+  bare_ffmpeg__packet_sync(packet->handle, packet->header);
+}
+
 static js_arraybuffer_t
 bare_ffmpeg_packet_init_from_buffer(
   js_env_t *env,
@@ -3647,9 +6623,111 @@ bare_ffmpeg_packet_init_from_buffer(
 
   packet->handle = pkt;
 
+  bare_ffmpeg__packet_sync(packet->handle, packet->header);
+
+  return handle;
+}
+
+static js_arraybuffer_t
+bare_ffmpeg_packet_pool_init(
+  js_env_t *env,
+  js_receiver_t,
+  int32_t min_size
+) {
+  int err;
+
+  js_arraybuffer_t handle;
+
+  bare_ffmpeg_packet_pool_t *pool;
+  err = js_create_arraybuffer(env, pool, handle);
+  assert(err == 0);
+
+  for (int i = 0; i < BARE_FFMPEG_PACKET_POOL_CLASSES; i++) {
+    pool->classes[i] = NULL;
+  }
+
+  pool->min_size = min_size;
+
   return handle;
 }
 
+static void
+bare_ffmpeg_packet_pool_destroy(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_packet_pool_t, 1> pool
+) {
+  for (int i = 0; i < BARE_FFMPEG_PACKET_POOL_CLASSES; i++) {
+    av_buffer_pool_uninit(&pool->classes[i]);
+  }
+}
+
+static void
+bare_ffmpeg_packet_pool_get(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_packet_pool_t, 1> pool,
+  js_arraybuffer_span_of_t<bare_ffmpeg_packet_t, 1> packet,
+  uint32_t size,
+  std::optional<js_arraybuffer_span_t> data,
+  uint32_t offset
+) {
+  int err;
+
+  auto target = packet->handle;
+
+  av_packet_unref(target);
+
+  // Size classes double from the minimum size, each with its own pool of
+  // padded buffers. Larger packets fall back to a regular allocation.
+  int i = 0;
+  int64_t capacity = pool->min_size;
+
+  while (capacity < size && i < BARE_FFMPEG_PACKET_POOL_CLASSES) {
+    capacity <<= 1;
+    i++;
+  }
+
+  if (i == BARE_FFMPEG_PACKET_POOL_CLASSES) {
+    err = av_new_packet(target, static_cast<int>(size));
+  } else {
+    if (pool->classes[i] == NULL) {
+      pool->classes[i] = av_buffer_pool_init(capacity + AV_INPUT_BUFFER_PADDING_SIZE, NULL);
+    }
+
+    auto buf = av_buffer_pool_get(pool->classes[i]);
+
+    if (buf == NULL) {
+      err = AVERROR(ENOMEM);
+    } else {
+      target->buf = buf;
+      target->data = buf->data;
+      target->size = static_cast<int>(size);
+
+      memset(target->data + size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+
+      err = 0;
+    }
+  }
+
+  if (err < 0) {
+    bare_ffmpeg__packet_sync(target, packet->header);
+
+    err = js_throw_error(env, NULL, av_err2str(err));
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  if (data) {
+    assert(offset + size <= data->size());
+
+    memcpy(target->data, &(*data)[offset], size);
+  }
+
+  bare_ffmpeg__packet_sync(target, packet->header);
+}
+
 static void
 bare_ffmpeg_packet_unref(
   js_env_t *env,
@@ -3657,6 +6735,8 @@ bare_ffmpeg_packet_unref(
   js_arraybuffer_span_of_t<bare_ffmpeg_packet_t, 1> packet
 ) {
   av_packet_unref(packet->handle);
+
+  bare_ffmpeg__packet_sync(packet->handle, packet->header);
 }
 
 static void
@@ -3685,6 +6765,8 @@ bare_ffmpeg_packet_set_stream_index(
   int32_t value
 ) {
   packet->handle->stream_index = value;
+
+  bare_ffmpeg__packet_sync(packet->handle, packet->header);
 }
 
 static js_arraybuffer_t
@@ -3699,13 +6781,203 @@ bare_ffmpeg_packet_get_data(
 
   js_arraybuffer_t handle;
 
+  // Expose reference counted payloads without copying. The view holds its
+  // own reference to the underlying buffer, which is released when the
+  // ArrayBuffer is garbage collected.
+  if (packet->handle->buf && size > 0) {
+    auto buf = av_buffer_ref(packet->handle->buf);
+
+    if (buf) {
+      js_value_t *value;
+      err = js_create_external_arraybuffer(env, packet->handle->data, size, bare_ffmpeg__on_buffer_view_finalize, buf, &value);
+      assert(err == 0);
+
+      return js_arraybuffer_t(value);
+    }
+  }
+
   uint8_t *data;
   err = js_create_arraybuffer(env, size, data, handle);
   assert(err == 0);
 
-  memcpy(data, packet->handle->data, size);
+  memcpy(data, packet->handle->data, size);
+
+  return handle;
+}
+
+static void
+bare_ffmpeg_frame_wrap(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame,
+  js_arraybuffer_t buffer,
+  uint64_t offset,
+  uint64_t len,
+  int32_t format,
+  int32_t width,
+  int32_t height,
+  int32_t align
+) {
+  int err;
+
+  auto pixel_format = static_cast<AVPixelFormat>(format);
+
+  auto size = av_image_get_buffer_size(pixel_format, width, height, align);
+  if (size < 0) {
+    err = js_throw_error(env, NULL, av_err2str(size));
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  if (static_cast<uint64_t>(size) > len) {
+    err = js_throw_error(env, NULL, "Buffer is too small for the image");
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  std::span<uint8_t> view;
+  err = js_get_arraybuffer_info(env, buffer, view);
+  assert(err == 0);
+
+  assert(offset + len <= view.size());
+
+  auto target = frame->handle;
+
+  av_frame_unref(target);
+
+  // The frame holds a reference to the pinned ArrayBuffer, so encoders that
+  // retain the frame, including on other threads, keep the memory alive. The
+  // buffer is read-only so that av_frame_make_writable() and in-place
+  // filters copy the image instead of writing into JavaScript memory.
+  auto buf = bare_ffmpeg__pin_create(env, buffer, &view[offset], static_cast<size_t>(size), AV_BUFFER_FLAG_READONLY);
+  if (buf == NULL) {
+    bare_ffmpeg__frame_sync(target, frame->header);
+
+    err = js_throw_error(env, NULL, av_err2str(AVERROR(ENOMEM)));
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  target->buf[0] = buf;
+  target->format = format;
+  target->width = width;
+  target->height = height;
+
+  err = av_image_fill_arrays(target->data, target->linesize, buf->data, pixel_format, width, height, align);
+  assert(err >= 0);
+
+  target->extended_data = target->data;
+
+  bare_ffmpeg__frame_sync(target, frame->header);
+}
+
+static std::vector<size_t>
+bare_ffmpeg__frame_plane_sizes(AVFrame *frame) {
+  int err;
+
+  std::vector<size_t> sizes;
+
+  if (frame->nb_samples > 0) {
+    auto format = static_cast<AVSampleFormat>(frame->format);
+
+    if (format == AV_SAMPLE_FMT_NONE) return sizes;
+
+    auto count = av_sample_fmt_is_planar(format) ? frame->ch_layout.nb_channels : 1;
+
+    sizes.assign(count, static_cast<size_t>(frame->linesize[0]));
+  } else {
+    auto format = static_cast<AVPixelFormat>(frame->format);
+    auto desc = av_pix_fmt_desc_get(format);
+
+    if (desc == NULL || (desc->flags & AV_PIX_FMT_FLAG_HWACCEL)) return sizes;
+
+    ptrdiff_t linesize[4];
+
+    for (int i = 0; i < 4; i++) {
+      // Bottom-up images have no contiguous view
+      if (frame->linesize[i] < 0) return sizes;
+
+      linesize[i] = frame->linesize[i];
+    }
+
+    size_t plane_sizes[4];
+    err = av_image_fill_plane_sizes(plane_sizes, format, frame->height, linesize);
+    if (err < 0) return sizes;
+
+    sizes.assign(plane_sizes, plane_sizes + av_pix_fmt_count_planes(format));
+  }
+
+  for (size_t i = 0; i < sizes.size(); i++) {
+    if (frame->extended_data == NULL || frame->extended_data[i] == NULL) {
+      sizes.resize(i);
+      break;
+    }
+  }
+
+  return sizes;
+}
+
+static js_arraybuffer_t
+bare_ffmpeg__frame_plane_view(js_env_t *env, AVFrame *frame, int plane, size_t size) {
+  int err;
+
+  auto data = frame->extended_data[plane];
+
+  auto buf = av_frame_get_plane_buffer(frame, plane);
+
+  // Planes backed by a reference counted buffer are exposed in place and
+  // keep that buffer alive, anything else is copied
+  if (buf && (buf = av_buffer_ref(buf))) {
+    js_value_t *value;
+    err = js_create_external_arraybuffer(env, data, size, bare_ffmpeg__on_buffer_view_finalize, buf, &value);
+    assert(err == 0);
+
+    return js_arraybuffer_t(value);
+  }
+
+  js_arraybuffer_t handle;
+
+  uint8_t *copy;
+  err = js_create_arraybuffer(env, size, copy, handle);
+  assert(err == 0);
+
+  memcpy(copy, data, size);
+
+  return handle;
+}
+
+static std::vector<js_arraybuffer_t>
+bare_ffmpeg_frame_get_planes(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame
+) {
+  auto sizes = bare_ffmpeg__frame_plane_sizes(frame->handle);
+
+  std::vector<js_arraybuffer_t> planes;
+
+  for (size_t i = 0; i < sizes.size(); i++) {
+    planes.push_back(bare_ffmpeg__frame_plane_view(env, frame->handle, static_cast<int>(i), sizes[i]));
+  }
+
+  return planes;
+}
+
+static std::optional<js_arraybuffer_t>
+bare_ffmpeg_frame_get_plane(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame,
+  uint32_t plane
+) {
+  auto sizes = bare_ffmpeg__frame_plane_sizes(frame->handle);
 
-  return handle;
+  if (plane >= sizes.size()) return std::nullopt;
+
+  return bare_ffmpeg__frame_plane_view(env, frame->handle, static_cast<int>(plane), sizes[plane]);
 }
 
 static void
@@ -3727,6 +6999,8 @@ bare_ffmpeg_packet_set_data(
   assert(err == 0);
 
   memcpy(packet->handle->data, &data[offset], len);
+
+  bare_ffmpeg__packet_sync(packet->handle, packet->header);
 }
 
 static std::vector<js_arraybuffer_t>
@@ -3806,6 +7080,8 @@ bare_ffmpeg_packet_set_is_keyframe(
   } else {
     packet->handle->flags &= ~AV_PKT_FLAG_KEY;
   }
+
+  bare_ffmpeg__packet_sync(packet->handle, packet->header);
 }
 
 static int64_t
@@ -3829,6 +7105,8 @@ bare_ffmpeg_packet_set_dts(
   int64_t value
 ) {
   packet->handle->dts = value;
+
+  bare_ffmpeg__packet_sync(packet->handle, packet->header);
 }
 
 static int64_t
@@ -3852,6 +7130,8 @@ bare_ffmpeg_packet_set_pts(
   int64_t value
 ) {
   packet->handle->pts = value;
+
+  bare_ffmpeg__packet_sync(packet->handle, packet->header);
 }
 
 static js_arraybuffer_t
@@ -3884,6 +7164,8 @@ bare_ffmpeg_packet_set_time_base(
 ) {
   packet->handle->time_base.num = num;
   packet->handle->time_base.den = den;
+
+  bare_ffmpeg__packet_sync(packet->handle, packet->header);
 }
 
 static void
@@ -3900,6 +7182,8 @@ bare_ffmpeg_packet_rescale_ts(
     {src_num, src_den},
     {dst_num, dst_den}
   );
+
+  bare_ffmpeg__packet_sync(packet->handle, packet->header);
 }
 
 static int64_t
@@ -3919,6 +7203,8 @@ bare_ffmpeg_packet_set_duration(
   int64_t value
 ) {
   packet->handle->duration = value;
+
+  bare_ffmpeg__packet_sync(packet->handle, packet->header);
 }
 
 static int32_t
@@ -3938,6 +7224,8 @@ bare_ffmpeg_packet_set_flags(
   int32_t value
 ) {
   packet->handle->flags = value;
+
+  bare_ffmpeg__packet_sync(packet->handle, packet->header);
 }
 
 static void
@@ -3956,6 +7244,8 @@ bare_ffmpeg_packet_copy_props(
 
     throw js_pending_exception;
   }
+
+  bare_ffmpeg__packet_sync(dst->handle, dst->header);
 }
 
 static int
@@ -3987,74 +7277,561 @@ bare_ffmpeg_side_data_get_data(
   int err = js_create_arraybuffer(env, side_data->handle->size, buf, handle);
   assert(err == 0);
 
-  memcpy(buf, side_data->handle->data, side_data->handle->size);
+  memcpy(buf, side_data->handle->data, side_data->handle->size);
+
+  return handle;
+}
+
+static js_arraybuffer_t
+bare_ffmpeg_scaler_init(
+  js_env_t *env,
+  js_receiver_t,
+  int64_t source_format,
+  int32_t source_width,
+  int32_t source_height,
+  int64_t target_format,
+  int32_t target_width,
+  int32_t target_height,
+  int32_t flags,
+  int32_t threads
+) {
+  int err;
+
+  js_arraybuffer_t handle;
+
+  bare_ffmpeg_scaler_t *scaler;
+  err = js_create_arraybuffer(env, scaler, handle);
+  assert(err == 0);
+
+  scaler->handle = sws_alloc_context();
+
+  av_opt_set_int(scaler->handle, "srcw", source_width, 0);
+  av_opt_set_int(scaler->handle, "srch", source_height, 0);
+  av_opt_set_int(scaler->handle, "src_format", source_format, 0);
+  av_opt_set_int(scaler->handle, "dstw", target_width, 0);
+  av_opt_set_int(scaler->handle, "dsth", target_height, 0);
+  av_opt_set_int(scaler->handle, "dst_format", target_format, 0);
+  av_opt_set_int(scaler->handle, "sws_flags", flags, 0);
+
+  // Slices are only scaled in parallel by sws_scale_frame(), the legacy
+  // sws_scale() entry point always runs on the calling thread
+  av_opt_set_int(scaler->handle, "threads", threads, 0);
+
+  err = sws_init_context(scaler->handle, NULL, NULL);
+  if (err < 0) {
+    sws_freeContext(scaler->handle);
+    scaler->handle = NULL;
+
+    err = js_throw_error(env, NULL, av_err2str(err));
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  return handle;
+}
+
+static void
+bare_ffmpeg_scaler_destroy(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_scaler_t, 1> scaler
+) {
+  sws_freeContext(scaler->handle);
+}
+
+static int
+bare_ffmpeg_scaler_scale(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_scaler_t, 1> scaler,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> source,
+  int y,
+  int height,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> target
+) {
+  return sws_scale(
+    scaler->handle,
+    reinterpret_cast<const uint8_t *const *>(source->handle->data),
+    source->handle->linesize,
+    y,
+    height,
+    target->handle->data,
+    target->handle->linesize
+  );
+}
+
+static void
+bare_ffmpeg_scaler_set_colorspace_details(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_scaler_t, 1> scaler,
+  int32_t source_matrix,
+  bool source_full_range,
+  int32_t target_matrix,
+  bool target_full_range
+) {
+  int err;
+
+  err = sws_setColorspaceDetails(
+    scaler->handle,
+    sws_getCoefficients(source_matrix),
+    source_full_range,
+    sws_getCoefficients(target_matrix),
+    target_full_range,
+    0,
+    1 << 16,
+    1 << 16
+  );
+
+  if (err < 0) {
+    err = js_throw_error(env, NULL, "Colorspace details are not supported for these pixel formats");
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+}
+
+static int
+bare_ffmpeg__scaler_scale_frame(struct SwsContext *context, AVFrame *target, const AVFrame *source) {
+  // sws_scale_frame() allocates targets without a buffer reference, so
+  // targets pointing at caller owned memory, such as a filled Image, go
+  // through the serial path instead
+  if (target->buf[0] == NULL && target->data[0] != NULL) {
+    auto lines = sws_scale(
+      context,
+      reinterpret_cast<const uint8_t *const *>(source->data),
+      source->linesize,
+      0,
+      source->height,
+      target->data,
+      target->linesize
+    );
+
+    return lines < 0 ? lines : 0;
+  }
+
+  return sws_scale_frame(context, target, source);
+}
+
+static int
+bare_ffmpeg_scaler_scale_frame(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_scaler_t, 1> scaler,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> source,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> target
+) {
+  int err;
+
+  err = bare_ffmpeg__scaler_scale_frame(scaler->handle, target->handle, source->handle);
+
+  bare_ffmpeg__frame_sync(target->handle, target->header);
+
+  if (err < 0) {
+    err = js_throw_error(env, NULL, av_err2str(err));
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  return target->handle->height;
+}
+
+static int
+bare_ffmpeg__scaler_ref_target(AVFrame *ref, const AVFrame *target) {
+  if (target->buf[0]) return av_frame_ref(ref, target);
+
+  // Targets without buffers are either allocated by the scaler or point at
+  // caller owned memory, which is aliased as is
+  ref->format = target->format;
+  ref->width = target->width;
+  ref->height = target->height;
+
+  for (int i = 0; i < AV_NUM_DATA_POINTERS; i++) {
+    ref->data[i] = target->data[i];
+    ref->linesize[i] = target->linesize[i];
+  }
+
+  return 0;
+}
+
+static int
+bare_ffmpeg__scaler_complete_target(bare_ffmpeg_frame_t *target, AVFrame *ref, bool allocate) {
+  if (target->handle == NULL) return 0;
+
+  // Frames without buffers are allocated by the scaler, so hand the new
+  // buffers over to the target
+  if (allocate) {
+    av_frame_unref(target->handle);
+    av_frame_move_ref(target->handle, ref);
+  }
+
+  bare_ffmpeg__frame_sync(target->handle, target->header);
+
+  return target->handle->height;
+}
+
+static void
+bare_ffmpeg__scaler_task_start(js_env_t *env, bare_ffmpeg_scaler_task_t *task) {
+  int err;
+
+  uv_loop_t *loop;
+  err = js_get_env_loop(env, &loop);
+  assert(err == 0);
+
+  err = uv_queue_work(loop, &task->handle, task->work, task->done);
+  assert(err == 0);
+}
+
+static void
+bare_ffmpeg__scaler_task_queue(js_env_t *env, bare_ffmpeg_scaler_task_t *task, uv_work_cb work, uv_after_work_cb done) {
+  auto owner = task->owner;
+
+  task->work = work;
+  task->done = done;
+  task->next = NULL;
+
+  if (owner->queue_tail) {
+    owner->queue_tail->next = task;
+    owner->queue_tail = task;
+  } else {
+    owner->queue_head = owner->queue_tail = task;
+
+    bare_ffmpeg__scaler_task_start(env, task);
+  }
+}
+
+static void
+bare_ffmpeg__scaler_task_dequeue(js_env_t *env, bare_ffmpeg_scaler_task_t *task) {
+  auto owner = task->owner;
+
+  assert(owner->queue_head == task);
+
+  owner->queue_head = task->next;
+
+  if (owner->queue_head) bare_ffmpeg__scaler_task_start(env, owner->queue_head);
+  else owner->queue_tail = NULL;
+}
+
+static void
+bare_ffmpeg__scaler_retain_memory(js_env_t *env, std::vector<js_persistent_t<js_arraybuffer_t>> &refs, std::vector<js_arraybuffer_t> &memory) {
+  int err;
+
+  refs = std::vector<js_persistent_t<js_arraybuffer_t>>(memory.size());
+
+  for (size_t i = 0, n = memory.size(); i < n; i++) {
+    err = js_create_reference(env, memory[i], refs[i]);
+    assert(err == 0);
+  }
+}
+
+static void
+bare_ffmpeg__on_scaler_job_work(uv_work_t *handle) {
+  auto job = reinterpret_cast<bare_ffmpeg_scaler_job_t *>(handle);
+
+  job->status = bare_ffmpeg__scaler_scale_frame(job->context, job->target, job->source);
+}
+
+static void
+bare_ffmpeg__on_scaler_job_done(uv_work_t *handle, int status) {
+  int err;
+
+  auto job = reinterpret_cast<bare_ffmpeg_scaler_job_t *>(handle);
+
+  auto env = job->env;
+
+  bare_ffmpeg__scaler_task_dequeue(env, &job->task);
+
+  js_handle_scope_t *scope;
+  err = js_open_handle_scope(env, &scope);
+  assert(err == 0);
+
+  int32_t result = job->status;
+
+  if (result >= 0) {
+    result = bare_ffmpeg__scaler_complete_target(job->target_frame, job->target, job->allocate);
+  }
+
+  bare_ffmpeg_scaler_job_cb_t callback;
+  err = js_get_reference_value(env, job->on_complete, callback);
+  assert(err == 0);
+
+  job->scaler_ref.reset();
+  job->target_ref.reset();
+  job->memory_refs.clear();
+  job->on_complete.reset();
+
+  av_frame_free(&job->source);
+  av_frame_free(&job->target);
+
+  delete job;
+
+  err = js_call_function(env, callback, result);
+  assert(err == 0);
+
+  err = js_close_handle_scope(env, scope);
+  assert(err == 0);
+}
+
+static void
+bare_ffmpeg_scaler_scale_async(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_t scaler_handle,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> source,
+  js_arraybuffer_t target_handle,
+  std::vector<js_arraybuffer_t> memory,
+  bare_ffmpeg_scaler_job_cb_t on_complete
+) {
+  int err;
+
+  std::span<uint8_t> view;
+
+  err = js_get_arraybuffer_info(env, scaler_handle, view);
+  assert(err == 0);
+
+  auto scaler = reinterpret_cast<bare_ffmpeg_scaler_t *>(view.data());
+
+  err = js_get_arraybuffer_info(env, target_handle, view);
+  assert(err == 0);
+
+  auto target = reinterpret_cast<bare_ffmpeg_frame_t *>(view.data());
+
+  auto job = new bare_ffmpeg_scaler_job_t();
+
+  job->task.owner = scaler;
+  job->env = env;
+  job->context = scaler->handle;
+  job->target_frame = target;
+  job->source = av_frame_alloc();
+  job->target = av_frame_alloc();
+  job->allocate = target->handle->buf[0] == NULL && target->handle->data[0] == NULL;
+
+  // The worker operates on references so the frames may be reused from
+  // JavaScript while it runs. Writes into the target buffers are shared.
+  err = av_frame_ref(job->source, source->handle);
+
+  if (err >= 0) {
+    err = bare_ffmpeg__scaler_ref_target(job->target, target->handle);
+  }
+
+  if (err < 0) {
+    av_frame_free(&job->source);
+    av_frame_free(&job->target);
+
+    delete job;
+
+    err = js_throw_error(env, NULL, av_err2str(err));
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  err = js_create_reference(env, scaler_handle, job->scaler_ref);
+  assert(err == 0);
+
+  err = js_create_reference(env, target_handle, job->target_ref);
+  assert(err == 0);
+
+  // Targets filled from an Image alias its memory without a buffer reference,
+  // so the backing ArrayBuffer is kept alive until the job completes
+  bare_ffmpeg__scaler_retain_memory(env, job->memory_refs, memory);
+
+  err = js_create_reference(env, on_complete, job->on_complete);
+  assert(err == 0);
+
+  bare_ffmpeg__scaler_task_queue(env, &job->task, bare_ffmpeg__on_scaler_job_work, bare_ffmpeg__on_scaler_job_done);
+}
+
+static void
+bare_ffmpeg_scaler_scale_ladder(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> source,
+  std::vector<js_arraybuffer_t> scalers,
+  std::vector<js_arraybuffer_t> targets
+) {
+  int err;
+
+  std::span<uint8_t> view;
+
+  int status = 0;
+
+  for (size_t i = 0, n = scalers.size(); i < n; i++) {
+    err = js_get_arraybuffer_info(env, scalers[i], view);
+    assert(err == 0);
+
+    auto scaler = reinterpret_cast<bare_ffmpeg_scaler_t *>(view.data());
+
+    err = js_get_arraybuffer_info(env, targets[i], view);
+    assert(err == 0);
+
+    auto target = reinterpret_cast<bare_ffmpeg_frame_t *>(view.data());
+
+    err = bare_ffmpeg__scaler_scale_frame(scaler->handle, target->handle, source->handle);
+
+    bare_ffmpeg__frame_sync(target->handle, target->header);
+
+    if (err < 0) {
+      status = err;
+      break;
+    }
+  }
+
+  if (status < 0) {
+    err = js_throw_error(env, NULL, av_err2str(status));
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+}
 
-  return handle;
+static void
+bare_ffmpeg__on_scaler_ladder_rung_work(uv_work_t *handle) {
+  auto rung = reinterpret_cast<bare_ffmpeg_scaler_ladder_rung_t *>(handle);
+
+  auto job = reinterpret_cast<bare_ffmpeg_scaler_ladder_job_t *>(handle->data);
+
+  rung->status = bare_ffmpeg__scaler_scale_frame(rung->context, rung->target, job->source);
 }
 
-static js_arraybuffer_t
-bare_ffmpeg_scaler_init(
-  js_env_t *env,
-  js_receiver_t,
-  int64_t source_format,
-  int32_t source_width,
-  int32_t source_height,
-  int64_t target_format,
-  int32_t target_width,
-  int32_t target_height
-) {
+static void
+bare_ffmpeg__on_scaler_ladder_rung_done(uv_work_t *handle, int status) {
   int err;
 
-  js_arraybuffer_t handle;
+  auto rung = reinterpret_cast<bare_ffmpeg_scaler_ladder_rung_t *>(handle);
 
-  bare_ffmpeg_scaler_t *scaler;
-  err = js_create_arraybuffer(env, scaler, handle);
+  auto job = reinterpret_cast<bare_ffmpeg_scaler_ladder_job_t *>(handle->data);
+
+  auto env = job->env;
+
+  bare_ffmpeg__scaler_task_dequeue(env, &rung->task);
+
+  // Every rung runs as its own work request, so only the last one to finish
+  // completes the job
+  if (--job->pending > 0) return;
+
+  js_handle_scope_t *scope;
+  err = js_open_handle_scope(env, &scope);
   assert(err == 0);
 
-  scaler->handle = sws_getContext(
-    source_width,
-    source_height,
-    static_cast<AVPixelFormat>(source_format),
-    target_width,
-    target_height,
-    static_cast<AVPixelFormat>(target_format),
-    SWS_BICUBIC,
-    NULL,
-    NULL,
-    NULL
-  );
+  int32_t result = 0;
 
-  return handle;
-}
+  for (auto &rung : job->rungs) {
+    if (rung.status < 0) {
+      if (result == 0) result = rung.status;
+    } else {
+      bare_ffmpeg__scaler_complete_target(rung.target_frame, rung.target, rung.allocate);
+    }
 
-static void
-bare_ffmpeg_scaler_destroy(
-  js_env_t *env,
-  js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_scaler_t, 1> scaler
-) {
-  sws_freeContext(scaler->handle);
+    rung.scaler_ref.reset();
+    rung.target_ref.reset();
+
+    av_frame_free(&rung.target);
+  }
+
+  bare_ffmpeg_scaler_job_cb_t callback;
+  err = js_get_reference_value(env, job->on_complete, callback);
+  assert(err == 0);
+
+  job->memory_refs.clear();
+  job->on_complete.reset();
+
+  av_frame_free(&job->source);
+
+  delete job;
+
+  err = js_call_function(env, callback, result);
+  assert(err == 0);
+
+  err = js_close_handle_scope(env, scope);
+  assert(err == 0);
 }
 
-static int
-bare_ffmpeg_scaler_scale(
+static void
+bare_ffmpeg_scaler_scale_ladder_async(
   js_env_t *env,
   js_receiver_t,
-  js_arraybuffer_span_of_t<bare_ffmpeg_scaler_t, 1> scaler,
   js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> source,
-  int y,
-  int height,
-  js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> target
+  std::vector<js_arraybuffer_t> scalers,
+  std::vector<js_arraybuffer_t> targets,
+  std::vector<js_arraybuffer_t> memory,
+  bare_ffmpeg_scaler_job_cb_t on_complete
 ) {
-  return sws_scale(
-    scaler->handle,
-    reinterpret_cast<const uint8_t *const *>(source->handle->data),
-    source->handle->linesize,
-    y,
-    height,
-    target->handle->data,
-    target->handle->linesize
-  );
+  int err;
+
+  std::span<uint8_t> view;
+
+  auto job = new bare_ffmpeg_scaler_ladder_job_t();
+
+  job->env = env;
+  job->source = av_frame_alloc();
+  job->rungs = std::vector<bare_ffmpeg_scaler_ladder_rung_t>(scalers.size());
+  job->pending = scalers.size();
+
+  // All rungs share a single reference to the source, which the workers only
+  // read from
+  err = av_frame_ref(job->source, source->handle);
+
+  for (size_t i = 0, n = scalers.size(); i < n; i++) {
+    auto &rung = job->rungs[i];
+
+    rung.task.handle.data = job;
+    rung.target = av_frame_alloc();
+
+    if (err < 0) continue;
+
+    err = js_get_arraybuffer_info(env, scalers[i], view);
+    assert(err == 0);
+
+    rung.task.owner = reinterpret_cast<bare_ffmpeg_scaler_t *>(view.data());
+    rung.context = rung.task.owner->handle;
+
+    err = js_get_arraybuffer_info(env, targets[i], view);
+    assert(err == 0);
+
+    auto target = reinterpret_cast<bare_ffmpeg_frame_t *>(view.data());
+
+    rung.target_frame = target;
+    rung.allocate = target->handle->buf[0] == NULL && target->handle->data[0] == NULL;
+
+    err = bare_ffmpeg__scaler_ref_target(rung.target, target->handle);
+  }
+
+  if (err < 0) {
+    for (auto &rung : job->rungs) av_frame_free(&rung.target);
+
+    av_frame_free(&job->source);
+
+    delete job;
+
+    err = js_throw_error(env, NULL, av_err2str(err));
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  for (size_t i = 0, n = scalers.size(); i < n; i++) {
+    auto &rung = job->rungs[i];
+
+    err = js_create_reference(env, scalers[i], rung.scaler_ref);
+    assert(err == 0);
+
+    err = js_create_reference(env, targets[i], rung.target_ref);
+    assert(err == 0);
+  }
+
+  bare_ffmpeg__scaler_retain_memory(env, job->memory_refs, memory);
+
+  err = js_create_reference(env, on_complete, job->on_complete);
+  assert(err == 0);
+
+  // Each rung waits for earlier operations on its own scaler, so rungs of
+  // different scalers still run in parallel
+  for (auto &rung : job->rungs) {
+    bare_ffmpeg__scaler_task_queue(env, &rung.task, bare_ffmpeg__on_scaler_ladder_rung_work, bare_ffmpeg__on_scaler_ladder_rung_done);
+  }
 }
 
 static js_arraybuffer_t
@@ -4250,6 +8027,8 @@ bare_ffmpeg_resampler_flush(
 
   out_frame->handle->nb_samples = result;
 
+  bare_ffmpeg__frame_sync(out_frame->handle, out_frame->header);
+
   return result;
 }
 
@@ -4282,6 +8061,15 @@ bare_ffmpeg_channel_layout_copy(
   return result;
 }
 
+static void
+bare_ffmpeg_channel_layout_destroy(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_channel_layout_t, 1> layout
+) {
+  av_channel_layout_uninit(&layout->handle);
+}
+
 static int
 bare_ffmpeg_channel_layout_get_nb_channels(
   js_env_t *env,
@@ -4467,6 +8255,172 @@ bare_ffmpeg_audio_fifo_space(
   return av_audio_fifo_space(fifo->handle);
 }
 
+static js_arraybuffer_t
+bare_ffmpeg_bitstream_filter_init(
+  js_env_t *env,
+  js_receiver_t,
+  std::string filters
+) {
+  int err;
+
+  js_arraybuffer_t handle;
+
+  bare_ffmpeg_bitstream_filter_t *bsf;
+  err = js_create_arraybuffer(env, bsf, handle);
+  assert(err == 0);
+
+  // Accepts a single filter name as well as a comma separated chain
+  err = av_bsf_list_parse_str(filters.c_str(), &bsf->handle);
+  if (err < 0) {
+    err = js_throw_error(env, NULL, av_err2str(err));
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  return handle;
+}
+
+static void
+bare_ffmpeg_bitstream_filter_destroy(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_bitstream_filter_t, 1> bsf
+) {
+  av_bsf_free(&bsf->handle);
+}
+
+static void
+bare_ffmpeg_bitstream_filter_open(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_bitstream_filter_t, 1> bsf,
+  js_arraybuffer_span_of_t<bare_ffmpeg_codec_parameters_t, 1> parameters,
+  int num,
+  int den
+) {
+  int err;
+
+  err = avcodec_parameters_copy(bsf->handle->par_in, parameters->handle);
+  if (err < 0) {
+    err = js_throw_error(env, NULL, av_err2str(err));
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  bsf->handle->time_base_in = av_make_q(num, den);
+
+  err = av_bsf_init(bsf->handle);
+  if (err < 0) {
+    err = js_throw_error(env, NULL, av_err2str(err));
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+}
+
+static js_arraybuffer_t
+bare_ffmpeg_bitstream_filter_get_output_parameters(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_bitstream_filter_t, 1> bsf
+) {
+  int err;
+
+  js_arraybuffer_t handle;
+
+  bare_ffmpeg_codec_parameters_t *parameters;
+  err = js_create_arraybuffer(env, parameters, handle);
+  assert(err == 0);
+
+  parameters->handle = bsf->handle->par_out;
+
+  return handle;
+}
+
+static js_arraybuffer_t
+bare_ffmpeg_bitstream_filter_get_output_time_base(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_bitstream_filter_t, 1> bsf
+) {
+  int err;
+
+  js_arraybuffer_t result;
+
+  int32_t *data;
+  err = js_create_arraybuffer(env, 2, data, result);
+  assert(err == 0);
+
+  data[0] = bsf->handle->time_base_out.num;
+  data[1] = bsf->handle->time_base_out.den;
+
+  return result;
+}
+
+static bool
+bare_ffmpeg_bitstream_filter_send_packet(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_bitstream_filter_t, 1> bsf,
+  std::optional<js_arraybuffer_span_of_t<bare_ffmpeg_packet_t, 1>> packet
+) {
+  int err;
+
+  // av_bsf_send_packet() takes ownership of the packet data and resets the
+  // packet, so the header has to be refreshed afterwards
+  if (packet) {
+    err = av_bsf_send_packet(bsf->handle, (*packet)->handle);
+  } else {
+    err = av_bsf_send_packet(bsf->handle, NULL);
+  }
+
+  if (err < 0 && err != AVERROR(EAGAIN) && err != AVERROR_EOF) {
+    err = js_throw_error(env, NULL, av_err2str(err));
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  if (packet) bare_ffmpeg__packet_sync((*packet)->handle, (*packet)->header);
+
+  return err == 0;
+}
+
+static bool
+bare_ffmpeg_bitstream_filter_receive_packet(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_bitstream_filter_t, 1> bsf,
+  js_arraybuffer_span_of_t<bare_ffmpeg_packet_t, 1> packet
+) {
+  int err;
+
+  av_packet_unref(packet->handle);
+
+  err = av_bsf_receive_packet(bsf->handle, packet->handle);
+  if (err < 0 && err != AVERROR(EAGAIN) && err != AVERROR_EOF) {
+    err = js_throw_error(env, NULL, av_err2str(err));
+    assert(err == 0);
+
+    throw js_pending_exception;
+  }
+
+  bare_ffmpeg__packet_sync(packet->handle, packet->header);
+
+  return err == 0;
+}
+
+static void
+bare_ffmpeg_bitstream_filter_flush(
+  js_env_t *env,
+  js_receiver_t,
+  js_arraybuffer_span_of_t<bare_ffmpeg_bitstream_filter_t, 1> bsf
+) {
+  av_bsf_flush(bsf->handle);
+}
+
 static js_arraybuffer_t
 bare_ffmpeg_rational_d2q(
   js_env_t *env,
@@ -4627,7 +8581,11 @@ bare_ffmpeg_filter_graph_push_frame(
   js_arraybuffer_span_of_t<bare_ffmpeg_filter_context_t, 1> ctx,
   js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame
 ) {
-  return av_buffersrc_add_frame(ctx->handle, frame->handle);
+  int err = av_buffersrc_add_frame(ctx->handle, frame->handle);
+
+  bare_ffmpeg__frame_sync(frame->handle, frame->header);
+
+  return err;
 }
 
 static int
@@ -4637,7 +8595,11 @@ bare_ffmpeg_filter_graph_pull_frame(
   js_arraybuffer_span_of_t<bare_ffmpeg_filter_context_t, 1> ctx,
   js_arraybuffer_span_of_t<bare_ffmpeg_frame_t, 1> frame
 ) {
-  return av_buffersink_get_frame(ctx->handle, frame->handle);
+  int err = av_buffersink_get_frame(ctx->handle, frame->handle);
+
+  bare_ffmpeg__frame_sync(frame->handle, frame->header);
+
+  return err;
 }
 
 static js_arraybuffer_t
@@ -4938,9 +8900,17 @@ bare_ffmpeg_exports(js_env_t *env, js_value_t *exports) {
 
   V("getLogLevel", bare_ffmpeg_log_get_level);
   V("setLogLevel", bare_ffmpeg_log_set_level);
+  V("getErrorString", bare_ffmpeg_get_error_string);
 
   V("initIOContext", bare_ffmpeg_io_context_init)
+  V("initIOContextFromFile", bare_ffmpeg_io_context_init_from_file)
+  V("initIOContextFromBuffer", bare_ffmpeg_io_context_init_from_buffer)
   V("destroyIOContext", bare_ffmpeg_io_context_destroy)
+  V("initIOContextStream", bare_ffmpeg_io_context_init_stream)
+  V("pushIOContext", bare_ffmpeg_io_context_push)
+  V("endIOContext", bare_ffmpeg_io_context_end)
+  V("flushIOContext", bare_ffmpeg_io_context_flush)
+  V("getIOContextBuffered", bare_ffmpeg_io_context_get_buffered)
 
   V("initInputFormat", bare_ffmpeg_input_format_init)
   V("getInputFormatFlags", bare_ffmpeg_input_format_get_flags)
@@ -4955,10 +8925,12 @@ bare_ffmpeg_exports(js_env_t *env, js_value_t *exports) {
   V("getOutputFormatName", bare_ffmpeg_output_format_get_name)
 
   V("openInputFormatContextWithIO", bare_ffmpeg_format_context_open_input_with_io)
+  V("openInputFormatContextWithIOAsync", bare_ffmpeg_format_context_open_input_with_io_async)
   V("openInputFormatContextWithFormat", bare_ffmpeg_format_context_open_input_with_format)
   V("closeInputFormatContext", bare_ffmpeg_format_context_close_input)
 
   V("openOutputFormatContext", bare_ffmpeg_format_context_open_output)
+  V("openOutputFormatContextWithPath", bare_ffmpeg_format_context_open_output_with_path)
   V("closeOutputFormatContext", bare_ffmpeg_format_context_close_output)
 
   V("getFormatContextStreams", bare_ffmpeg_format_context_get_streams)
@@ -4966,9 +8938,15 @@ bare_ffmpeg_exports(js_env_t *env, js_value_t *exports) {
   V("getFormatContextBestStreamIndex", bare_ffmpeg_format_context_get_best_stream_index)
   V("createFormatContextStream", bare_ffmpeg_format_context_create_stream)
   V("readFormatContextFrame", bare_ffmpeg_format_context_read_frame)
+  V("abortFormatContext", bare_ffmpeg_format_context_abort)
+  V("setFormatContextTimeout", bare_ffmpeg_format_context_set_timeout)
+  V("readFormatContextFrameAsync", bare_ffmpeg_format_context_read_frame_async)
+  V("readFormatContextFrames", bare_ffmpeg_format_context_read_frames)
+  V("seekFormatContextFrame", bare_ffmpeg_format_context_seek_frame)
   V("writeFormatContextHeader", bare_ffmpeg_format_context_write_header)
   V("writeFormatContextFrame", bare_ffmpeg_format_context_write_frame)
   V("writeFormatContextTrailer", bare_ffmpeg_format_context_write_trailer)
+  V("remuxFormatContext", bare_ffmpeg_format_context_remux)
   V("dumpFormatContext", bare_ffmpeg_format_context_dump)
   V("getFormatContextOutputFormat", get_bare_ffmpeg_format_context_output_format)
   V("getFormatContextInputFormat", get_bare_ffmpeg_format_context_input_format)
@@ -4983,6 +8961,8 @@ bare_ffmpeg_exports(js_env_t *env, js_value_t *exports) {
   V("getStreamCodecParameters", bare_ffmpeg_stream_get_codec_parameters)
   V("getStreamSideData", bare_ffmpeg_stream_get_side_data)
   V("getStreamDuration", bare_ffmpeg_stream_get_duration)
+  V("getStreamIndexEntries", bare_ffmpeg_stream_get_index_entries)
+  V("searchStreamIndexEntry", bare_ffmpeg_stream_search_index_entry)
   V("setStreamDuration", bare_ffmpeg_stream_set_duration)
 
   V("findDecoderByID", bare_ffmpeg_find_decoder_by_id)
@@ -5001,6 +8981,11 @@ bare_ffmpeg_exports(js_env_t *env, js_value_t *exports) {
   V("openCodecContext", bare_ffmpeg_codec_context_open)
   V("openCodecContextWithOptions", bare_ffmpeg_codec_context_open_with_options)
   V("getCodecContextFlags", bare_ffmpeg_codec_context_get_flags)
+  V("getCodecContextThreadCount", bare_ffmpeg_codec_context_get_thread_count)
+  V("setCodecContextThreadCount", bare_ffmpeg_codec_context_set_thread_count)
+  V("getCodecContextThreadType", bare_ffmpeg_codec_context_get_thread_type)
+  V("setCodecContextThreadType", bare_ffmpeg_codec_context_set_thread_type)
+  V("getCodecContextCapabilities", bare_ffmpeg_codec_context_get_capabilities)
   V("setCodecContextFlags", bare_ffmpeg_codec_context_set_flags)
   V("getCodecContextPixelFormat", bare_ffmpeg_codec_context_get_pixel_format)
   V("setCodecContextPixelFormat", bare_ffmpeg_codec_context_set_pixel_format)
@@ -5027,16 +9012,24 @@ bare_ffmpeg_exports(js_env_t *env, js_value_t *exports) {
   V("getCodecContextRequestSampleFormat", bare_ffmpeg_codec_context_get_request_sample_format)
   V("setCodecContextRequestSampleFormat", bare_ffmpeg_codec_context_set_request_sample_format)
   V("setCodecContextGetFormat", bare_ffmpeg_codec_context_set_get_format)
+  V("setCodecContextBufferPool", bare_ffmpeg_codec_context_set_buffer_pool)
   V("getCodecContextHWDeviceCtx", bare_ffmpeg_codec_context_get_hw_device_ctx)
   V("setCodecContextHWDeviceCtx", bare_ffmpeg_codec_context_set_hw_device_ctx)
 
+  V("flushCodecContext", bare_ffmpeg_codec_context_flush)
   V("sendCodecContextPacket", bare_ffmpeg_codec_context_send_packet)
   V("receiveCodecContextPacket", bare_ffmpeg_codec_context_receive_packet)
   V("sendCodecContextFrame", bare_ffmpeg_codec_context_send_frame)
   V("receiveCodecContextFrame", bare_ffmpeg_codec_context_receive_frame)
+  V("sendCodecContextPacketAsync", bare_ffmpeg_codec_context_send_packet_async)
+  V("receiveCodecContextFrameAsync", bare_ffmpeg_codec_context_receive_frame_async)
+  V("sendCodecContextFrameAsync", bare_ffmpeg_codec_context_send_frame_async)
+  V("receiveCodecContextPacketAsync", bare_ffmpeg_codec_context_receive_packet_async)
+  V("encodeCodecContextFrameAsync", bare_ffmpeg_codec_context_encode_async)
 
   V("codecParametersFromContext", bare_ffmpeg_codec_parameters_from_context)
   V("codecParametersToContext", bare_ffmpeg_codec_parameters_to_context)
+  V("copyCodecParameters", bare_ffmpeg_codec_parameters_copy)
   V("allocCodecParameters", bare_ffmpeg_codec_parameters_alloc)
   V("destroyCodecParameters", bare_ffmpeg_codec_parameters_destroy)
   V("getCodecParametersBitRate", bare_ffmpeg_codec_parameters_get_bit_rate)
@@ -5137,6 +9130,14 @@ bare_ffmpeg_exports(js_env_t *env, js_value_t *exports) {
   V("getFrameHWFramesCtx", bare_ffmpeg_frame_get_hw_frames_ctx)
   V("setFrameHWFramesCtx", bare_ffmpeg_frame_set_hw_frames_ctx)
   V("allocFrame", bare_ffmpeg_frame_alloc)
+  V("getFramePlanes", bare_ffmpeg_frame_get_planes)
+  V("getFramePlane", bare_ffmpeg_frame_get_plane)
+  V("wrapFrame", bare_ffmpeg_frame_wrap)
+
+  V("initVideoFramePool", bare_ffmpeg_frame_pool_init_video)
+  V("initAudioFramePool", bare_ffmpeg_frame_pool_init_audio)
+  V("destroyFramePool", bare_ffmpeg_frame_pool_destroy)
+  V("getFramePoolFrame", bare_ffmpeg_frame_pool_get)
 
   V("initHWDeviceContext", bare_ffmpeg_hw_device_context_init)
   V("destroyHWDeviceContext", bare_ffmpeg_hw_device_context_destroy)
@@ -5177,10 +9178,15 @@ bare_ffmpeg_exports(js_env_t *env, js_value_t *exports) {
   V("initPacketFromBuffer", bare_ffmpeg_packet_init_from_buffer)
   V("destroyPacket", bare_ffmpeg_packet_destroy)
   V("unrefPacket", bare_ffmpeg_packet_unref)
+
+  V("initPacketPool", bare_ffmpeg_packet_pool_init)
+  V("destroyPacketPool", bare_ffmpeg_packet_pool_destroy)
+  V("getPacketPoolPacket", bare_ffmpeg_packet_pool_get)
   V("getPacketStreamIndex", bare_ffmpeg_packet_get_stream_index)
   V("setPacketStreamIndex", bare_ffmpeg_packet_set_stream_index)
   V("getPacketData", bare_ffmpeg_packet_get_data)
   V("setPacketData", bare_ffmpeg_packet_set_data)
+  V("wrapPacket", bare_ffmpeg_packet_wrap)
   V("getPacketSideData", bare_ffmpeg_packet_get_side_data)
   V("setPacketSideData", bare_ffmpeg_packet_set_side_data)
   V("isPacketKeyframe", bare_ffmpeg_packet_is_keyframe)
@@ -5205,6 +9211,11 @@ bare_ffmpeg_exports(js_env_t *env, js_value_t *exports) {
   V("initScaler", bare_ffmpeg_scaler_init)
   V("destroyScaler", bare_ffmpeg_scaler_destroy)
   V("scaleScaler", bare_ffmpeg_scaler_scale)
+  V("scaleScalerFrame", bare_ffmpeg_scaler_scale_frame)
+  V("scaleScalerAsync", bare_ffmpeg_scaler_scale_async)
+  V("setScalerColorspaceDetails", bare_ffmpeg_scaler_set_colorspace_details)
+  V("scaleScalerLadder", bare_ffmpeg_scaler_scale_ladder)
+  V("scaleScalerLadderAsync", bare_ffmpeg_scaler_scale_ladder_async)
 
   V("initDictionary", bare_ffmpeg_dictionary_init)
   V("destroyDictionary", bare_ffmpeg_dictionary_destroy)
@@ -5219,6 +9230,7 @@ bare_ffmpeg_exports(js_env_t *env, js_value_t *exports) {
   V("flushResampler", bare_ffmpeg_resampler_flush)
 
   V("copyChannelLayout", bare_ffmpeg_channel_layout_copy)
+  V("destroyChannelLayout", bare_ffmpeg_channel_layout_destroy)
   V("getChannelLayoutNbChannels", bare_ffmpeg_channel_layout_get_nb_channels)
   V("getChannelLayoutMask", bare_ffmpeg_channel_layout_get_mask)
   V("channelLayoutFromMask", bare_ffmpeg_channel_layout_from_mask)
@@ -5233,6 +9245,15 @@ bare_ffmpeg_exports(js_env_t *env, js_value_t *exports) {
   V("getAudioFifoSize", bare_ffmpeg_audio_fifo_size)
   V("getAudioFifoSpace", bare_ffmpeg_audio_fifo_space)
 
+  V("initBitstreamFilter", bare_ffmpeg_bitstream_filter_init)
+  V("destroyBitstreamFilter", bare_ffmpeg_bitstream_filter_destroy)
+  V("openBitstreamFilter", bare_ffmpeg_bitstream_filter_open)
+  V("getBitstreamFilterOutputParameters", bare_ffmpeg_bitstream_filter_get_output_parameters)
+  V("getBitstreamFilterOutputTimeBase", bare_ffmpeg_bitstream_filter_get_output_time_base)
+  V("sendBitstreamFilterPacket", bare_ffmpeg_bitstream_filter_send_packet)
+  V("receiveBitstreamFilterPacket", bare_ffmpeg_bitstream_filter_receive_packet)
+  V("flushBitstreamFilter", bare_ffmpeg_bitstream_filter_flush)
+
   V("rationalD2Q", bare_ffmpeg_rational_d2q)
   V("rationalRescaleQ", bare_ffmpeg_rational_rescale_q)
 
@@ -5316,6 +9337,43 @@ bare_ffmpeg_exports(js_env_t *env, js_value_t *exports) {
   V(AV_CODEC_FLAG_INTERLACED_ME)
   V(AV_CODEC_FLAG_CLOSED_GOP)
 
+  V(AV_INPUT_BUFFER_PADDING_SIZE)
+
+  V(BARE_FFMPEG_FRAME_HEADER_OFFSET)
+  V(BARE_FFMPEG_FRAME_FIELDS_OFFSET)
+  V(BARE_FFMPEG_PACKET_HEADER_OFFSET)
+  V(BARE_FFMPEG_PACKET_FIELDS_OFFSET)
+
+  V(AV_PKT_FLAG_KEY)
+  V(AVERROR_EXIT)
+
+  V(SWS_FAST_BILINEAR)
+  V(SWS_BILINEAR)
+  V(SWS_BICUBIC)
+  V(SWS_X)
+  V(SWS_POINT)
+  V(SWS_AREA)
+  V(SWS_BICUBLIN)
+  V(SWS_GAUSS)
+  V(SWS_SINC)
+  V(SWS_LANCZOS)
+  V(SWS_SPLINE)
+  V(SWS_FULL_CHR_H_INT)
+  V(SWS_FULL_CHR_H_INP)
+  V(SWS_ACCURATE_RND)
+  V(SWS_BITEXACT)
+
+  V(FF_THREAD_FRAME)
+  V(FF_THREAD_SLICE)
+
+  V(AV_CODEC_CAP_DELAY)
+  V(AV_CODEC_CAP_FRAME_THREADS)
+  V(AV_CODEC_CAP_SLICE_THREADS)
+  V(AV_CODEC_CAP_OTHER_THREADS)
+  V(AV_CODEC_CAP_EXPERIMENTAL)
+  V(AV_CODEC_CAP_HARDWARE)
+  V(AV_CODEC_CAP_HYBRID)
+
   V(AV_PIX_FMT_NONE)
   V(AV_PIX_FMT_RGBA)
   V(AV_PIX_FMT_RGB24)
@@ -5589,6 +9647,13 @@ bare_ffmpeg_exports(js_env_t *env, js_value_t *exports) {
   V(SEEK_SET)
   V(SEEK_END)
 
+  V(AVSEEK_FLAG_BACKWARD)
+  V(AVSEEK_FLAG_BYTE)
+  V(AVSEEK_FLAG_ANY)
+  V(AVSEEK_FLAG_FRAME)
+
+  V(AVINDEX_KEYFRAME)
+
   V(AV_PKT_DATA_PALETTE)
   V(AV_PKT_DATA_NEW_EXTRADATA)
   V(AV_PKT_DATA_PARAM_CHANGE)
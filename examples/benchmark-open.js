@@ -0,0 +1,58 @@
+const ffmpeg = require('..')
+
+console.log('Open Latency Benchmark')
+console.log('======================\n')
+
+const fixtures = {
+  'video/sample.mp4': require('../test/fixtures/video/sample.mp4', {
+    with: { type: 'binary' }
+  }),
+  'video/sample.webm': require('../test/fixtures/video/sample.webm', {
+    with: { type: 'binary' }
+  }),
+  'audio/sample.mp3': require('../test/fixtures/audio/sample.mp3', {
+    with: { type: 'binary' }
+  }),
+  'audio/sample.aiff': require('../test/fixtures/audio/sample.aiff', {
+    with: { type: 'binary' }
+  })
+}
+
+const iterations = 50
+
+const configurations = [
+  { name: 'default', options: {} },
+  { name: 'small probe', options: { probesize: 32768, analyzeduration: 100000 } },
+  { name: 'skip stream info', options: { skipStreamInfo: true } }
+]
+
+console.log(`${iterations} iterations per run, time to open and read the first packet\n`)
+
+for (const [name, data] of Object.entries(fixtures)) {
+  console.log(`${name}:`)
+
+  for (const { name, options } of configurations) {
+    // Warm up the demuxer before timing
+    open(data, options)
+
+    const start = Date.now()
+
+    for (let i = 0; i < iterations; i++) open(data, options)
+
+    const elapsed = Date.now() - start
+    const latency = (elapsed / iterations).toFixed(3)
+
+    console.log(
+      `  ${name.padEnd(18)} ${String(elapsed).padStart(6)} ms ${latency.padStart(9)} ms/open`
+    )
+  }
+
+  console.log()
+}
+
+function open(data, options) {
+  using format = new ffmpeg.InputFormatContext(new ffmpeg.IOContext(data), options)
+  using packet = new ffmpeg.Packet()
+
+  format.readFrame(packet)
+}
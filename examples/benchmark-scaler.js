@@ -0,0 +1,74 @@
+const ffmpeg = require('..')
+
+console.log('Scaler Algorithm Benchmark')
+console.log('==========================\n')
+
+const image = require('../test/fixtures/image/sample.jpeg', {
+  with: { type: 'binary' }
+})
+
+const iterations = 50
+
+using source = decodeImage(image)
+
+console.log(`Source: ${source.width}x${source.height}, ${iterations} iterations per run\n`)
+
+const targets = [
+  { name: 'thumbnail', width: 160, height: 90 },
+  { name: 'half', width: source.width >> 1, height: source.height >> 1 },
+  { name: 'double', width: source.width * 2, height: source.height * 2 }
+]
+
+for (const target of targets) {
+  console.log(`${target.name} (${target.width}x${target.height}):`)
+
+  using frame = new ffmpeg.Frame()
+  frame.width = target.width
+  frame.height = target.height
+  frame.format = ffmpeg.constants.pixelFormats.YUV420P
+  frame.alloc()
+
+  for (const algorithm of Object.keys(ffmpeg.constants.scalerAlgorithms)) {
+    using scaler = new ffmpeg.Scaler(
+      source.format,
+      source.width,
+      source.height,
+      frame.format,
+      frame.width,
+      frame.height,
+      { algorithm }
+    )
+
+    // Warm up the filter caches before timing
+    scaler.scale(source, frame)
+
+    const start = Date.now()
+
+    for (let i = 0; i < iterations; i++) scaler.scale(source, frame)
+
+    const elapsed = Date.now() - start
+    const fps = elapsed === 0 ? Infinity : Math.round((iterations * 1000) / elapsed)
+
+    console.log(
+      `  ${algorithm.padEnd(14)} ${String(elapsed).padStart(6)} ms ${String(fps).padStart(8)} fps`
+    )
+  }
+
+  console.log()
+}
+
+function decodeImage(image) {
+  using io = new ffmpeg.IOContext(image)
+  using format = new ffmpeg.InputFormatContext(io)
+  using packet = new ffmpeg.Packet()
+  format.readFrame(packet)
+
+  using decoder = format.streams[0].decoder()
+  decoder.open()
+  decoder.sendPacket(packet)
+
+  const frame = new ffmpeg.Frame()
+  decoder.receiveFrame(frame)
+
+  return frame
+}
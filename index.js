@@ -1,4 +1,5 @@
 const AudioFIFO = require('./lib/audio-fifo')
+const BitstreamFilter = require('./lib/bitstream-filter')
 const ChannelLayout = require('./lib/channel-layout')
 const Codec = require('./lib/codec')
 const CodecContext = require('./lib/codec-context')
@@ -12,6 +13,7 @@ const FilterContext = require('./lib/filter-context')
 const FilterGraph = require('./lib/filter-graph')
 const FilterInOut = require('./lib/filter-inout')
 const Frame = require('./lib/frame')
+const FramePool = require('./lib/frame-pool')
 const HWDeviceContext = require('./lib/hw-device-context')
 const HWFramesContext = require('./lib/hw-frames-context')
 const HWFramesConstraints = require('./lib/hw-frames-constraints')
@@ -20,14 +22,18 @@ const Image = require('./lib/image')
 const InputFormat = require('./lib/input-format')
 const OutputFormat = require('./lib/output-format')
 const Packet = require('./lib/packet')
+const PacketPool = require('./lib/packet-pool')
 const Rational = require('./lib/rational')
+const remux = require('./lib/remux')
 const Resampler = require('./lib/resampler')
 const Samples = require('./lib/samples')
 const Scaler = require('./lib/scaler')
+const ScalerLadder = require('./lib/scaler-ladder')
 const Stream = require('./lib/stream')
 const log = require('./lib/log')
 
 exports.AudioFIFO = AudioFIFO
+exports.BitstreamFilter = BitstreamFilter
 exports.ChannelLayout = ChannelLayout
 exports.Codec = Codec
 exports.CodecContext = CodecContext
@@ -40,6 +46,7 @@ exports.FilterContext = FilterContext
 exports.FilterGraph = FilterGraph
 exports.FilterInOut = FilterInOut
 exports.Frame = Frame
+exports.FramePool = FramePool
 exports.HWDeviceContext = HWDeviceContext
 exports.HWFramesContext = HWFramesContext
 exports.HWFramesConstraints = HWFramesConstraints
@@ -50,11 +57,14 @@ exports.InputFormatContext = InputFormatContext
 exports.OutputFormat = OutputFormat
 exports.OutputFormatContext = OutputFormatContext
 exports.Packet = Packet
+exports.PacketPool = PacketPool
 exports.Samples = Samples
 exports.Scaler = Scaler
+exports.ScalerLadder = ScalerLadder
 exports.Stream = Stream
 exports.Rational = Rational
 exports.Resampler = Resampler
 exports.log = log
+exports.remux = remux
 
 exports.constants = require('./lib/constants')
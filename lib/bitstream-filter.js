@@ -0,0 +1,68 @@
+const binding = require('../binding')
+const CodecParameters = require('./codec-parameters')
+const Rational = require('./rational')
+const Stream = require('./stream')
+
+module.exports = class FFmpegBitstreamFilter {
+  constructor(filters) {
+    this._handle = binding.initBitstreamFilter(filters)
+    this._outputParameters = null
+  }
+
+  get outputParameters() {
+    if (this._outputParameters === null) {
+      this._outputParameters = new CodecParameters(
+        binding.getBitstreamFilterOutputParameters(this._handle)
+      )
+    }
+
+    return this._outputParameters
+  }
+
+  get outputTimeBase() {
+    const view = new Int32Array(binding.getBitstreamFilterOutputTimeBase(this._handle))
+    return new Rational(view[0], view[1])
+  }
+
+  open(parameters, timeBase) {
+    if (parameters instanceof Stream) {
+      timeBase = timeBase || parameters.timeBase
+      parameters = parameters.codecParameters
+    }
+
+    binding.openBitstreamFilter(
+      this._handle,
+      parameters._handle,
+      timeBase.numerator,
+      timeBase.denominator
+    )
+  }
+
+  sendPacket(packet) {
+    return binding.sendBitstreamFilterPacket(this._handle, packet ? packet._handle : undefined)
+  }
+
+  receivePacket(packet) {
+    return binding.receiveBitstreamFilterPacket(this._handle, packet._handle)
+  }
+
+  flush() {
+    binding.flushBitstreamFilter(this._handle)
+  }
+
+  destroy() {
+    binding.destroyBitstreamFilter(this._handle)
+    this._handle = null
+
+    // The parameters view the filter's own output parameters, which are freed
+    // along with it
+    if (this._outputParameters !== null) {
+      this._outputParameters._handle = null
+      this._outputParameters = null
+    }
+  }
+
+  [Symbol.dispose]() {
+    this.destroy()
+  }
+}
@@ -6,6 +6,10 @@ module.exports = class FFmpegChannelLayout {
     this._handle = handle
   }
 
+  destroy() {
+    binding.destroyChannelLayout(this._handle)
+  }
+
   get nbChannels() {
     return binding.getChannelLayoutNbChannels(this._handle)
   }
@@ -26,6 +30,10 @@ module.exports = class FFmpegChannelLayout {
     return new this(value)
   }
 
+  [Symbol.dispose]() {
+    this.destroy()
+  }
+
   [Symbol.for('bare.inspect')]() {
     return {
       __proto__: { constructor: FFmpegChannelLayout },
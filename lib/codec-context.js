@@ -2,16 +2,22 @@ const binding = require('../binding')
 const Rational = require('./rational')
 const ChannelLayout = require('./channel-layout')
 const HWDeviceContext = require('./hw-device-context')
-const { codecConfig, optionFlags } = require('./constants')
+const EncodeQueue = require('./encode-queue')
+const Packet = require('./packet')
+const errors = require('./errors')
+const { codecConfig, optionFlags, threadTypes, codecCapabilities } = require('./constants')
 
 module.exports = class FFmpegCodecContext {
   constructor(codec) {
     this._codec = codec
     this._opened = false
+    this._pending = 0
     this._handle = binding.initCodecContext(codec._handle)
   }
 
   destroy() {
+    this._assertIdle()
+
     binding.destroyCodecContext(this._handle)
     this._handle = null
   }
@@ -21,6 +27,8 @@ module.exports = class FFmpegCodecContext {
   }
 
   set pixelFormat(value) {
+    this._assertIdle()
+
     binding.setCodecContextPixelFormat(this._handle, value)
   }
 
@@ -29,6 +37,8 @@ module.exports = class FFmpegCodecContext {
   }
 
   set width(value) {
+    this._assertIdle()
+
     binding.setCodecContextWidth(this._handle, value)
   }
 
@@ -37,6 +47,8 @@ module.exports = class FFmpegCodecContext {
   }
 
   set height(value) {
+    this._assertIdle()
+
     binding.setCodecContextHeight(this._handle, value)
   }
 
@@ -45,6 +57,8 @@ module.exports = class FFmpegCodecContext {
   }
 
   set sampleFormat(value) {
+    this._assertIdle()
+
     return binding.setCodecContextSampleFormat(this._handle, value)
   }
 
@@ -53,6 +67,8 @@ module.exports = class FFmpegCodecContext {
   }
 
   set sampleRate(value) {
+    this._assertIdle()
+
     binding.setCodecContextSampleRate(this._handle, value)
   }
 
@@ -62,6 +78,8 @@ module.exports = class FFmpegCodecContext {
   }
 
   set timeBase(value) {
+    this._assertIdle()
+
     binding.setCodecContextTimeBase(this._handle, value.numerator, value.denominator)
   }
 
@@ -71,6 +89,8 @@ module.exports = class FFmpegCodecContext {
   }
 
   set frameRate(value) {
+    this._assertIdle()
+
     binding.setCodecContextFramerate(this._handle, value.numerator, value.denominator)
   }
 
@@ -79,6 +99,8 @@ module.exports = class FFmpegCodecContext {
   }
 
   set channelLayout(value) {
+    this._assertIdle()
+
     binding.setCodecContextChannelLayout(this._handle, ChannelLayout.from(value)._handle)
   }
 
@@ -87,6 +109,8 @@ module.exports = class FFmpegCodecContext {
   }
 
   set gopSize(value) {
+    this._assertIdle()
+
     binding.setCodecContextGOPSize(this._handle, value)
   }
 
@@ -95,14 +119,81 @@ module.exports = class FFmpegCodecContext {
   }
 
   set flags(value) {
+    this._assertIdle()
+
     binding.setCodecContextFlags(this._handle, value)
   }
 
+  get threadCount() {
+    return binding.getCodecContextThreadCount(this._handle)
+  }
+
+  set threadCount(value) {
+    this._assertIdle()
+
+    binding.setCodecContextThreadCount(this._handle, value)
+  }
+
+  get threadType() {
+    return binding.getCodecContextThreadType(this._handle)
+  }
+
+  set threadType(value) {
+    this._assertIdle()
+
+    binding.setCodecContextThreadType(this._handle, value)
+  }
+
+  get capabilities() {
+    return binding.getCodecContextCapabilities(this._handle)
+  }
+
+  setThreading(opts = {}) {
+    this._assertIdle()
+
+    const { threading = 'auto', threads = 0 } = opts
+
+    if (threading !== 'frame' && threading !== 'slice' && threading !== 'auto') {
+      throw new TypeError(`Threading must be 'frame', 'slice' or 'auto'. Received ${threading}`)
+    }
+
+    if (this._opened) {
+      throw errors.ALREADY_OPENED('Threading must be configured before opening the codec')
+    }
+
+    const capabilities = this.capabilities
+
+    // Codecs that manage their own threads, such as external libraries, only
+    // honour the thread count.
+    const other = (capabilities & codecCapabilities.OTHER_THREADS) !== 0
+
+    let type = 0
+
+    if (threading === 'frame' || threading === 'auto') {
+      if (capabilities & codecCapabilities.FRAME_THREADS) type |= threadTypes.FRAME
+      else if (threading === 'frame' && !other) {
+        throw errors.UNSUPPORTED_THREADING('Codec does not support frame threading')
+      }
+    }
+
+    if (threading === 'slice' || threading === 'auto') {
+      if (capabilities & codecCapabilities.SLICE_THREADS) type |= threadTypes.SLICE
+      else if (threading === 'slice' && !other) {
+        throw errors.UNSUPPORTED_THREADING('Codec does not support slice threading')
+      }
+    }
+
+    this.threadType = type
+    this.threadCount = threads
+  }
+
   get extraData() {
     return Buffer.from(binding.getCodecContextExtraData(this._handle))
   }
 
   set extraData(value) {
+    this._assertIdle()
+
     binding.setCodecContextExtraData(this._handle, value.buffer, value.byteOffset, value.byteLength)
   }
 
@@ -119,6 +210,8 @@ module.exports = class FFmpegCodecContext {
   }
 
   set requestSampleFormat(sampleFormat) {
+    this._assertIdle()
+
     binding.setCodecContextRequestSampleFormat(this._handle, sampleFormat)
   }
 
@@ -127,17 +220,31 @@ module.exports = class FFmpegCodecContext {
   }
 
   set hwDeviceCtx(hwDeviceContext) {
+    this._assertIdle()
+
     binding.setCodecContextHWDeviceCtx(this._handle, hwDeviceContext._handle)
   }
 
   set getFormat(callback) {
+    this._assertIdle()
+
     const wrap = (pixelFormats) => {
       return callback(this, pixelFormats)
     }
     binding.setCodecContextGetFormat(this._handle, wrap)
   }
 
+  useBufferPool(opts = {}) {
+    this._assertIdle()
+
+    const { align = 64 } = opts
+
+    binding.setCodecContextBufferPool(this._handle, align)
+  }
+
   open(options) {
+    this._assertIdle()
+
     if (this._opened) return
     this._opened = true
     if (options) {
@@ -147,15 +254,27 @@ module.exports = class FFmpegCodecContext {
     }
   }
 
+  flush() {
+    this._assertIdle()
+
+    binding.flushCodecContext(this._handle)
+  }
+
   sendPacket(packet) {
+    this._assertIdle()
+
     return binding.sendCodecContextPacket(this._handle, packet._handle)
   }
 
   receivePacket(packet) {
+    this._assertIdle()
+
     return binding.receiveCodecContextPacket(this._handle, packet._handle)
   }
 
   sendFrame(frame) {
+    this._assertIdle()
+
     let frameHandle = undefined
 
     if (frame) frameHandle = frame._handle
@@ -164,9 +283,68 @@ module.exports = class FFmpegCodecContext {
   }
 
   receiveFrame(frame) {
+    this._assertIdle()
+
     return binding.receiveCodecContextFrame(this._handle, frame._handle)
   }
 
+  sendPacketAsync(packet) {
+    let packetHandle = undefined
+
+    if (packet) packetHandle = packet._handle
+
+    return this._async(binding.sendCodecContextPacketAsync, packetHandle)
+  }
+
+  receiveFrameAsync(frame) {
+    return this._async(binding.receiveCodecContextFrameAsync, frame._handle)
+  }
+
+  sendFrameAsync(frame) {
+    let frameHandle = undefined
+
+    if (frame) frameHandle = frame._handle
+
+    return this._async(binding.sendCodecContextFrameAsync, frameHandle)
+  }
+
+  receivePacketAsync(packet) {
+    return this._async(binding.receiveCodecContextPacketAsync, packet._handle)
+  }
+
+  encodeAsync(frame) {
+    let frameHandle = undefined
+
+    if (frame) frameHandle = frame._handle
+
+    return this._async(binding.encodeCodecContextFrameAsync, frameHandle, toPackets)
+  }
+
+  encodeQueue(opts) {
+    return new EncodeQueue(this, opts)
+  }
+
+  // The binding references the packet or frame right away and runs the
+  // operations of a context one at a time, in the order they were issued
+  _async(fn, handle, map = toBoolean) {
+    return new Promise((resolve, reject) => {
+      fn(this._handle, handle, (status, result) => {
+        this._pending--
+
+        if (status < 0) reject(toError(status, result))
+        else resolve(map(status, result))
+      })
+
+      this._pending++
+    })
+  }
+
+  _assertIdle() {
+    if (this._pending > 0) {
+      throw errors.OPERATION_PENDING('Codec context has pending asynchronous operations')
+    }
+  }
+
   getSupportedConfig(config) {
     if (config === codecConfig.FRAME_RATE) {
       const data = binding.getSupportedFrameRates(this._handle, this._codec._handle)
@@ -201,14 +379,20 @@ module.exports = class FFmpegCodecContext {
   }
 
   setOption(name, value, flags = optionFlags.SEARCH_CHILDREN) {
+    this._assertIdle()
+
     return binding.setOption(this._handle, name, value, flags)
   }
 
   setOptionDictionary(dictionary, flags = optionFlags.SEARCH_CHILDREN) {
+    this._assertIdle()
+
     return binding.setOptionDictionary(this._handle, dictionary._handle, flags)
   }
 
   setOptionDefaults() {
+    this._assertIdle()
+
     return binding.setOptionDefaults(this._handle)
   }
 
@@ -231,6 +415,8 @@ module.exports = class FFmpegCodecContext {
   }
 
   copyOptionsFrom(codecContext) {
+    this._assertIdle()
+
     binding.copyOptions(this._handle, codecContext._handle)
   }
 
@@ -244,6 +430,8 @@ module.exports = class FFmpegCodecContext {
       _codec: this._codec,
       _opened: this._opened,
       flags: this.flags,
+      threadCount: this.threadCount,
+      threadType: this.threadType,
       pixelFormat: this.pixelFormat,
       width: this.width,
       height: this.height,
@@ -259,3 +447,23 @@ module.exports = class FFmpegCodecContext {
     }
   }
 }
+
+function toBoolean(status) {
+  return status === 1
+}
+
+function toPackets(status, handles) {
+  return handles.map((handle) => Packet.from(handle))
+}
+
+function toError(status, handles) {
+  const err = new Error(binding.getErrorString(status))
+
+  err.code = status
+  err.errno = status
+
+  // Packets encoded before the failure are not lost
+  if (Array.isArray(handles)) err.packets = toPackets(status, handles)
+
+  return err
+}
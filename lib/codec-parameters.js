@@ -243,6 +243,10 @@ module.exports = class FFmpegCodecParameters {
     binding.codecParametersToContext(context._handle, this._handle)
   }
 
+  copyFrom(parameters) {
+    binding.copyCodecParameters(this._handle, parameters._handle)
+  }
+
   destroy() {
     if (this._owned) binding.destroyCodecParameters(this._handle)
   }
@@ -131,6 +131,19 @@ module.exports = exports = {
     INTERLACED_ME: binding.AV_CODEC_FLAG_INTERLACED_ME,
     CLOSED_GOP: binding.AV_CODEC_FLAG_CLOSED_GOP
   },
+  threadTypes: {
+    FRAME: binding.FF_THREAD_FRAME,
+    SLICE: binding.FF_THREAD_SLICE
+  },
+  codecCapabilities: {
+    DELAY: binding.AV_CODEC_CAP_DELAY,
+    FRAME_THREADS: binding.AV_CODEC_CAP_FRAME_THREADS,
+    SLICE_THREADS: binding.AV_CODEC_CAP_SLICE_THREADS,
+    OTHER_THREADS: binding.AV_CODEC_CAP_OTHER_THREADS,
+    EXPERIMENTAL: binding.AV_CODEC_CAP_EXPERIMENTAL,
+    HARDWARE: binding.AV_CODEC_CAP_HARDWARE,
+    HYBRID: binding.AV_CODEC_CAP_HYBRID
+  },
   formatFlags: {
     SHOW_IDS: binding.AVFMT_SHOW_IDS,
     GENERIC_INDEX: binding.AVFMT_GENERIC_INDEX,
@@ -156,6 +169,31 @@ module.exports = exports = {
     SET: binding.SEEK_SET,
     END: binding.SEEK_END
   },
+  scalerAlgorithms: {
+    FAST_BILINEAR: binding.SWS_FAST_BILINEAR,
+    BILINEAR: binding.SWS_BILINEAR,
+    BICUBIC: binding.SWS_BICUBIC,
+    X: binding.SWS_X,
+    POINT: binding.SWS_POINT,
+    AREA: binding.SWS_AREA,
+    BICUBLIN: binding.SWS_BICUBLIN,
+    GAUSS: binding.SWS_GAUSS,
+    SINC: binding.SWS_SINC,
+    LANCZOS: binding.SWS_LANCZOS,
+    SPLINE: binding.SWS_SPLINE
+  },
+  scalerFlags: {
+    FULL_CHR_H_INT: binding.SWS_FULL_CHR_H_INT,
+    FULL_CHR_H_INP: binding.SWS_FULL_CHR_H_INP,
+    ACCURATE_RND: binding.SWS_ACCURATE_RND,
+    BITEXACT: binding.SWS_BITEXACT
+  },
+  seekFlags: {
+    BACKWARD: binding.AVSEEK_FLAG_BACKWARD,
+    BYTE: binding.AVSEEK_FLAG_BYTE,
+    ANY: binding.AVSEEK_FLAG_ANY,
+    FRAME: binding.AVSEEK_FLAG_FRAME
+  },
   packetSideDataType: {
     PALETTE: binding.AV_PKT_DATA_PALETTE,
     NEW_EXTRADATA: binding.AV_PKT_DATA_NEW_EXTRADATA,
@@ -0,0 +1,111 @@
+module.exports = class FFmpegEncodeQueue {
+  constructor(codecContext, opts = {}) {
+    const { capacity = 4, onpacket = null, ondrain = null } = opts
+
+    this._codecContext = codecContext
+    this._capacity = capacity
+    this._inflight = 0
+    this._ended = false
+    this._finished = false
+    this._error = null
+    this._packets = []
+    this._waiting = null
+
+    this.onpacket = onpacket
+    this.ondrain = ondrain
+  }
+
+  get capacity() {
+    return this._capacity
+  }
+
+  get pending() {
+    return this._inflight
+  }
+
+  get ended() {
+    return this._ended
+  }
+
+  write(frame) {
+    if (this._ended) throw new Error('Encode queue has ended')
+    if (this._error) throw this._error
+
+    this._enqueue(frame)
+
+    return this._inflight < this._capacity
+  }
+
+  end() {
+    if (this._ended) return
+
+    this._ended = true
+
+    this._enqueue(null)
+  }
+
+  async *[Symbol.asyncIterator]() {
+    while (true) {
+      if (this._packets.length > 0) {
+        yield this._packets.shift()
+        continue
+      }
+
+      if (this._error) throw this._error
+      if (this._finished) return
+
+      await new Promise((resolve) => {
+        this._waiting = resolve
+      })
+    }
+  }
+
+  _enqueue(frame) {
+    this._inflight++
+
+    this._codecContext.encodeAsync(frame).then(
+      (packets) => this._onencode(frame, packets),
+      (err) => this._onerror(err)
+    )
+  }
+
+  _onencode(frame, packets) {
+    const drained = this._inflight-- === this._capacity
+
+    for (const packet of packets) {
+      if (this.onpacket) this.onpacket(packet)
+      else this._packets.push(packet)
+    }
+
+    if (frame === null) this._finished = true
+
+    this._wakeup()
+
+    if (drained && !this._ended && this.ondrain) this.ondrain()
+  }
+
+  _onerror(err) {
+    const drained = this._inflight-- === this._capacity
+
+    for (const packet of err.packets || []) {
+      if (this.onpacket) this.onpacket(packet)
+      else this._packets.push(packet)
+    }
+
+    if (this._error === null) this._error = err
+
+    this._wakeup()
+
+    // Wake producers waiting for a drain so their next write() surfaces the error
+    if (drained && !this._ended && this.ondrain) this.ondrain()
+  }
+
+  _wakeup() {
+    const waiting = this._waiting
+
+    if (waiting === null) return
+
+    this._waiting = null
+    waiting()
+  }
+}
@@ -23,4 +23,24 @@ module.exports = class FFmpegError extends Error {
   static UNKNOWN_CHANNEL_LAYOUT(msg) {
     return new FFmpegError(msg, 'UNKNOWN_CHANNEL_LAYOUT', FFmpegError.UNKNOWN_CHANNEL_LAYOUT)
   }
+
+  static UNSUPPORTED_THREADING(msg) {
+    return new FFmpegError(msg, 'UNSUPPORTED_THREADING', FFmpegError.UNSUPPORTED_THREADING)
+  }
+
+  static ALREADY_OPENED(msg) {
+    return new FFmpegError(msg, 'ALREADY_OPENED', FFmpegError.ALREADY_OPENED)
+  }
+
+  static OPERATION_PENDING(msg) {
+    return new FFmpegError(msg, 'OPERATION_PENDING', FFmpegError.OPERATION_PENDING)
+  }
+
+  static ABORTED(msg = 'Operation was aborted') {
+    return new FFmpegError(msg, 'ABORTED', FFmpegError.ABORTED)
+  }
+
+  static TIMEOUT(msg = 'Operation timed out') {
+    return new FFmpegError(msg, 'TIMEOUT', FFmpegError.TIMEOUT)
+  }
 }
@@ -4,15 +4,23 @@ const OutputFormat = require('./output-format')
 const IOContext = require('./io-context')
 const InputFormat = require('./input-format')
 const Dictionary = require('./dictionary')
+const errors = require('./errors')
 /** @typedef {import('./packet')} Packet */
 
 class FFmpegFormatContext {
   constructor(io) {
     this._io = io ? io.transfer() : null
     this._streams = []
+    this._metadata = null
+    this._pending = 0
+    this._queue = Promise.resolve()
+    this._aborted = false
+    this._timeoutMs = 0
   }
 
   destroy() {
+    this._assertIdle()
+
     if (this._io) {
       this._io.destroy()
       this._io = null
@@ -32,7 +40,89 @@ class FFmpegFormatContext {
   }
 
   readFrame(packet) {
-    return binding.readFormatContextFrame(this._handle, packet._handle)
+    this._assertIdle()
+    this._assertBlocking()
+
+    try {
+      return binding.readFormatContextFrame(this._handle, packet._handle)
+    } catch (err) {
+      throw toError(err)
+    }
+  }
+
+  readFrameAsync(packet) {
+    packet._pending++
+
+    return this._async(binding.readFormatContextFrameAsync, packet._handle).finally(() => {
+      packet._pending--
+    })
+  }
+
+  readFrames(packets) {
+    this._assertIdle()
+    this._assertBlocking()
+
+    const len = packets.length * 6
+
+    if (this._metadata === null || this._metadata.length < len) {
+      this._metadata = new Float64Array(len)
+    }
+
+    const handles = new Array(packets.length)
+
+    for (let i = 0; i < packets.length; i++) handles[i] = packets[i]._handle
+
+    let count
+
+    try {
+      count = binding.readFormatContextFrames(this._handle, handles, this._metadata.buffer)
+    } catch (err) {
+      throw toError(err)
+    }
+
+    return this._metadata.subarray(0, count * 6)
+  }
+
+  _async(fn, handle) {
+    const run = () =>
+      new Promise((resolve, reject) => {
+        fn(this._handle, handle, (status) => {
+          if (status < 0) reject(this._error(status))
+          else resolve(status === 1)
+        })
+      })
+
+    this._pending++
+
+    const promise = this._queue.then(run).finally(() => {
+      this._pending--
+    })
+
+    this._queue = promise.catch(noop)
+
+    return promise
+  }
+
+  _assertIdle() {
+    if (this._pending > 0) {
+      throw errors.OPERATION_PENDING('Format context has pending asynchronous operations')
+    }
+  }
+
+  // Stream IOContexts only receive data while the loop thread is free, so they
+  // cannot be read synchronously from it
+  _assertBlocking() {
+    if (this._io !== null && this._io._stream !== null) {
+      throw new Error('IOContext streams can only be read asynchronously')
+    }
+  }
+
+  _error(status) {
+    if (status === binding.AVERROR_EXIT) {
+      return this._aborted ? errors.ABORTED() : errors.TIMEOUT()
+    }
+
+    return new Error(binding.getErrorString(status))
   }
 
   getBestStreamIndex(type) {
@@ -87,28 +177,125 @@ switch (Bare.platform) {
 
 exports.InputFormatContext = class FFmpegInputFormatContext extends FFmpegFormatContext {
   // eslint-disable-next-line
-  constructor(io, options, url = defaultURL) {
+  constructor(io, options, url = defaultURL, opts = {}) {
+    if (io === null) {
+      super()
+      return
+    }
+
     if (io instanceof IOContext) {
+      if (io._stream !== null) {
+        throw new Error('IOContext streams can only be opened with InputFormatContext.openAsync()')
+      }
+
       super(io)
 
+      const {
+        timeoutMs = 0,
+        probesize = -1,
+        analyzeduration = -1,
+        fpsprobesize = -1,
+        skipStreamInfo = false
+      } = options || {}
+
+      this._timeoutMs = timeoutMs
+
       try {
-        this._handle = binding.openInputFormatContextWithIO(this._io._handle)
+        this._handle = binding.openInputFormatContextWithIO(
+          this._io._handle,
+          timeoutMs,
+          probesize,
+          analyzeduration,
+          fpsprobesize,
+          !skipStreamInfo
+        )
       } catch (err) {
         super.destroy()
-        throw err
+        throw toError(err)
       }
     } else if (io instanceof InputFormat) {
       super()
 
+      const {
+        timeoutMs = 0,
+        probesize = -1,
+        analyzeduration = -1,
+        fpsprobesize = -1,
+        skipStreamInfo = false
+      } = opts
+
+      this._timeoutMs = timeoutMs
+
       options = options || new Dictionary()
 
       try {
-        this._handle = binding.openInputFormatContextWithFormat(io._handle, options._handle, url)
+        this._handle = binding.openInputFormatContextWithFormat(
+          io._handle,
+          options._handle,
+          url,
+          timeoutMs,
+          probesize,
+          analyzeduration,
+          fpsprobesize,
+          !skipStreamInfo
+        )
+      } catch (err) {
+        throw toError(err)
       } finally {
         options.destroy()
       }
     }
 
+    this._loadStreams()
+  }
+
+  static openAsync(io, opts = {}) {
+    const {
+      timeoutMs = 0,
+      probesize = -1,
+      analyzeduration = -1,
+      fpsprobesize = -1,
+      skipStreamInfo = false
+    } = opts
+
+    const context = new FFmpegInputFormatContext(null)
+    context._io = io.transfer()
+    context._timeoutMs = timeoutMs
+
+    return new Promise((resolve, reject) => {
+      const ondone = (status) => {
+        context._pending--
+
+        if (status < 0) {
+          const err = context._error(status)
+          context.destroy()
+          reject(err)
+        } else {
+          context._loadStreams()
+          resolve(context)
+        }
+      }
+
+      try {
+        context._handle = binding.openInputFormatContextWithIOAsync(
+          context._io._handle,
+          timeoutMs,
+          probesize,
+          analyzeduration,
+          fpsprobesize,
+          !skipStreamInfo,
+          ondone
+        )
+      } catch (err) {
+        context._io.destroy()
+        throw err
+      }
+
+      context._pending++
+    })
+  }
+
+  _loadStreams() {
     for (const handle of binding.getFormatContextStreams(this._handle)) {
       this._streams.push(new Stream(handle))
     }
@@ -125,19 +312,56 @@ exports.InputFormatContext = class FFmpegInputFormatContext extends FFmpegFormat
     binding.dumpFormatContext(this._handle, false, printIdx, printUrl)
   }
 
+  get timeoutMs() {
+    return this._timeoutMs
+  }
+
+  set timeoutMs(value) {
+    binding.setFormatContextTimeout(this._handle, value)
+    this._timeoutMs = value
+  }
+
+  // Aborting is terminal: the context cannot be re-armed, so every later
+  // interrupted operation reports ABORTED rather than TIMEOUT
+  abort() {
+    if (this._handle === null) return
+
+    this._aborted = true
+
+    binding.abortFormatContext(this._handle)
+  }
+
   get inputFormat() {
     const handle = binding.getFormatContextInputFormat(this._handle)
     if (handle) return InputFormat.from(handle)
   }
+
+  seek(streamIndex, timestamp, opts = {}) {
+    const { flags = 0 } = opts
+
+    this._assertIdle()
+    this._assertBlocking()
+
+    try {
+      binding.seekFormatContextFrame(this._handle, streamIndex, timestamp, flags)
+    } catch (err) {
+      throw toError(err)
+    }
+  }
 }
 
 exports.OutputFormatContext = class FFmpegOutputFormatContext extends FFmpegFormatContext {
   constructor(format, io) {
-    super(io)
+    super(typeof io === 'string' ? null : io)
 
     if (typeof format === 'string') format = new OutputFormat(format)
 
-    this._handle = binding.openOutputFormatContext(format._handle, this._io._handle)
+    if (typeof io === 'string') {
+      this._handle = binding.openOutputFormatContextWithPath(format._handle, io)
+    } else {
+      this._handle = binding.openOutputFormatContext(format._handle, this._io._handle)
+    }
+
     this._isOutput = true
   }
 
@@ -158,16 +382,25 @@ exports.OutputFormatContext = class FFmpegOutputFormatContext extends FFmpegForm
 
   /** @param {Dictionary} [options] format options */
   writeHeader(options) {
+    this._assertIdle()
+
     binding.writeFormatContextHeader(this._handle, options?._handle)
   }
 
   /** @param {Packet} packet */
   writeFrame(packet) {
+    this._assertIdle()
+
     binding.writeFormatContextFrame(this._handle, packet._handle)
   }
 
   writeTrailer() {
+    this._assertIdle()
+
     binding.writeFormatContextTrailer(this._handle)
+
+    // Hand over any data still coalesced in a partially filled chunk
+    if (this._io) this._io.flush()
   }
 
   dump(printIdx = 0, printUrl = '') {
@@ -179,3 +412,15 @@ exports.OutputFormatContext = class FFmpegOutputFormatContext extends FFmpegForm
     if (handle) return OutputFormat.from(handle)
   }
 }
+
+function noop() {}
+
+// Synchronous operations interrupted by abort() or a deadline throw plain
+// errors carrying the code, which are replaced by the errors asynchronous
+// operations reject with
+function toError(err) {
+  if (err.code === 'ABORTED') return errors.ABORTED()
+  if (err.code === 'TIMEOUT') return errors.TIMEOUT()
+
+  return err
+}
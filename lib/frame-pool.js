@@ -0,0 +1,60 @@
+const binding = require('../binding')
+const ChannelLayout = require('./channel-layout')
+const Frame = require('./frame')
+const constants = require('./constants')
+
+module.exports = class FFmpegFramePool {
+  constructor(opts = {}) {
+    const { align = 32, capacity = 16 } = opts
+
+    if (opts.sampleFormat !== undefined) {
+      // The pool keeps its own copy of the layout
+      const channelLayout = ChannelLayout.from(opts.channelLayout)
+
+      try {
+        this._handle = binding.initAudioFramePool(
+          constants.toSampleFormat(opts.sampleFormat),
+          channelLayout._handle,
+          opts.nbSamples,
+          align
+        )
+      } finally {
+        channelLayout.destroy()
+      }
+    } else {
+      this._handle = binding.initVideoFramePool(
+        constants.toPixelFormat(opts.format),
+        opts.width,
+        opts.height,
+        align
+      )
+    }
+
+    this._capacity = capacity
+    this._frames = []
+  }
+
+  get(frame = this._frames.pop() || new Frame()) {
+    binding.getFramePoolFrame(this._handle, frame._handle)
+    return frame
+  }
+
+  release(frame) {
+    frame.unref()
+
+    if (this._frames.length < this._capacity) this._frames.push(frame)
+    else frame.destroy()
+  }
+
+  destroy() {
+    for (const frame of this._frames) frame.destroy()
+    this._frames = []
+
+    binding.destroyFramePool(this._handle)
+    this._handle = null
+  }
+
+  [Symbol.dispose]() {
+    this.destroy()
+  }
+}
@@ -28,6 +28,9 @@ class FrameMetadata {
   }
 }
 
+const HEADER_OFFSET = binding.BARE_FFMPEG_FRAME_HEADER_OFFSET
+const FIELDS_OFFSET = binding.BARE_FFMPEG_FRAME_FIELDS_OFFSET
+
 const FrameSideData = SideData.from(
   binding.getFrameSideDataType,
   binding.getFrameSideDataName,
@@ -38,20 +41,32 @@ module.exports = class FFmpegFrame {
   constructor() {
     this._handle = binding.initFrame()
     this._metadata = null
+
+    // Caller owned memory the frame points at without holding a reference,
+    // such as the data of a filled Image
+    this._memory = null
+
+    // Mirrors of the native frame header, kept in sync by the binding
+    this._timestamps = new Float64Array(this._handle, HEADER_OFFSET, 2)
+    this._fields = new Int32Array(this._handle, FIELDS_OFFSET, 16)
   }
 
   destroy() {
     binding.destroyFrame(this._handle)
     this._handle = null
     this._metadata = null
+    this._memory = null
+    this._timestamps = null
+    this._fields = null
   }
 
   unref() {
     binding.unrefFrame(this._handle)
+    this._memory = null
   }
 
   get width() {
-    return binding.getFrameWidth(this._handle)
+    return this._fields[0]
   }
 
   set width(value) {
@@ -59,7 +74,7 @@ module.exports = class FFmpegFrame {
   }
 
   get height() {
-    return binding.getFrameHeight(this._handle)
+    return this._fields[1]
   }
 
   set height(value) {
@@ -67,7 +82,7 @@ module.exports = class FFmpegFrame {
   }
 
   get format() {
-    return binding.getFrameFormat(this._handle)
+    return this._fields[2]
   }
 
   set format(value) {
@@ -83,7 +98,7 @@ module.exports = class FFmpegFrame {
   }
 
   get nbSamples() {
-    return binding.getFrameNbSamples(this._handle)
+    return this._fields[3]
   }
 
   set nbSamples(value) {
@@ -91,11 +106,11 @@ module.exports = class FFmpegFrame {
   }
 
   get pictType() {
-    return binding.getFramePictType(this._handle)
+    return this._fields[5]
   }
 
   get pts() {
-    return binding.getFramePTS(this._handle)
+    return this._timestamps[0]
   }
 
   set pts(value) {
@@ -103,7 +118,7 @@ module.exports = class FFmpegFrame {
   }
 
   get packetDTS() {
-    return binding.getFramePacketDTS(this._handle)
+    return this._timestamps[1]
   }
 
   set packetDTS(value) {
@@ -111,8 +126,7 @@ module.exports = class FFmpegFrame {
   }
 
   get timeBase() {
-    const view = new Int32Array(binding.getFrameTimeBase(this._handle))
-    return new Rational(view[0], view[1])
+    return new Rational(this._fields[6], this._fields[7])
   }
 
   set timeBase(value) {
@@ -120,7 +134,7 @@ module.exports = class FFmpegFrame {
   }
 
   get sampleRate() {
-    return binding.getFrameSampleRate(this._handle)
+    return this._fields[4]
   }
 
   set sampleRate(value) {
@@ -174,6 +188,34 @@ module.exports = class FFmpegFrame {
     binding.mapFrame(destination._handle, this._handle, flags)
   }
 
+  get linesize() {
+    return this._fields.slice(8, 16)
+  }
+
+  get planes() {
+    return binding.getFramePlanes(this._handle).map((plane) => Buffer.from(plane))
+  }
+
+  getPlane(index) {
+    const plane = binding.getFramePlane(this._handle, index)
+    return plane ? Buffer.from(plane) : null
+  }
+
+  wrap(buffer, format, width, height, align = 1) {
+    binding.wrapFrame(
+      this._handle,
+      buffer.buffer,
+      buffer.byteOffset,
+      buffer.byteLength,
+      constants.toPixelFormat(format),
+      width,
+      height,
+      align
+    )
+
+    this._memory = null
+  }
+
   alloc() {
     binding.allocFrame(this._handle, 32)
   }
@@ -43,6 +43,8 @@ module.exports = class FFmpegImage {
       this._data.byteOffset,
       frame._handle
     )
+
+    frame._memory = this._data.buffer
   }
 
   read(frame) {
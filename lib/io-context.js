@@ -1,12 +1,32 @@
 const binding = require('../binding')
 
+const defaultBufferSize = 32768
+const defaultHighWaterMark = 1048576
+
 module.exports = class FFmpegIOContext {
   constructor(buffer, opts = {}) {
+    this._stream = null
+
     if (buffer === null && opts === null) {
       this._handle = null
       return
     }
 
+    if (typeof buffer === 'string') {
+      this._handle = binding.initIOContextFromFile(buffer, -1, opts.bufferSize || defaultBufferSize)
+      return
+    }
+
+    if (isBuffer(buffer) && !opts.onwrite && !opts.onread && !opts.onseek) {
+      this._handle = binding.initIOContextFromBuffer(
+        buffer.buffer,
+        buffer.byteOffset,
+        buffer.byteLength,
+        opts.bufferSize || defaultBufferSize
+      )
+      return
+    }
+
     let offset = 0
     let len = 0
 
@@ -27,10 +47,52 @@ module.exports = class FFmpegIOContext {
       len,
       opts.onwrite && onwriteWrapper.bind(null, opts.onwrite),
       opts.onread && onreadWrapper.bind(null, opts.onread),
-      opts.onseek
+      opts.onseek,
+      opts.writeChunkSize || 0
     )
   }
 
+  static fromFileDescriptor(fd, opts = {}) {
+    const io = new FFmpegIOContext(null, null)
+    io._handle = binding.initIOContextFromFile(null, fd, opts.bufferSize || defaultBufferSize)
+    return io
+  }
+
+  static stream(opts = {}) {
+    const {
+      bufferSize = defaultBufferSize,
+      highWaterMark = defaultHighWaterMark,
+      ondrain = noop
+    } = opts
+
+    const io = new FFmpegIOContext(null, null)
+    io._handle = binding.initIOContextStream(bufferSize, highWaterMark, ondrain)
+    io._stream = io._handle
+    return io
+  }
+
+  get buffered() {
+    if (this._stream === null) return 0
+
+    return binding.getIOContextBuffered(this._stream)
+  }
+
+  push(chunk) {
+    if (this._stream === null) throw new Error('IOContext is not a stream')
+
+    return binding.pushIOContext(this._stream, chunk.buffer, chunk.byteOffset, chunk.byteLength)
+  }
+
+  end() {
+    if (this._stream === null) throw new Error('IOContext is not a stream')
+
+    binding.endIOContext(this._stream)
+  }
+
+  flush() {
+    if (this._handle) binding.flushIOContext(this._handle)
+  }
+
   destroy() {
     if (this._handle) {
       binding.destroyIOContext(this._handle)
@@ -42,6 +104,10 @@ module.exports = class FFmpegIOContext {
     const to = new FFmpegIOContext(null, null)
     to._handle = this._handle
     this._handle = null
+
+    // Streams stay writable after their ownership is transferred
+    to._stream = this._stream
+
     return to
   }
 
@@ -50,6 +116,10 @@ module.exports = class FFmpegIOContext {
   }
 }
 
+function isBuffer(value) {
+  return ArrayBuffer.isView(value)
+}
+
 function onwriteWrapper(target, arraybuffer) {
   return target(Buffer.from(arraybuffer))
 }
@@ -57,3 +127,5 @@ function onwriteWrapper(target, arraybuffer) {
 function onreadWrapper(target, arraybuffer, requestedLen) {
   return target(Buffer.from(arraybuffer), requestedLen)
 }
+
+function noop() {}
@@ -0,0 +1,49 @@
+const binding = require('../binding')
+const Packet = require('./packet')
+
+module.exports = class FFmpegPacketPool {
+  constructor(opts = {}) {
+    const { minSize = 256, capacity = 64 } = opts
+
+    this._handle = binding.initPacketPool(minSize)
+    this._capacity = capacity
+    this._packets = []
+  }
+
+  acquire(data = 0) {
+    const packet = this._packets.pop() || new Packet()
+
+    if (typeof data === 'number') {
+      binding.getPacketPoolPacket(this._handle, packet._handle, data, undefined, 0)
+    } else {
+      binding.getPacketPoolPacket(
+        this._handle,
+        packet._handle,
+        data.byteLength,
+        data.buffer,
+        data.byteOffset
+      )
+    }
+
+    return packet
+  }
+
+  release(packet) {
+    packet.unref()
+
+    if (this._packets.length < this._capacity) this._packets.push(packet)
+    else packet.destroy()
+  }
+
+  destroy() {
+    for (const packet of this._packets) packet.destroy()
+    this._packets = []
+
+    binding.destroyPacketPool(this._handle)
+    this._handle = null
+  }
+
+  [Symbol.dispose]() {
+    this.destroy()
+  }
+}
@@ -1,10 +1,18 @@
 const binding = require('../binding')
 const Rational = require('./rational')
 const PacketSideData = require('./packet-side-data')
+const errors = require('./errors')
+
+const HEADER_OFFSET = binding.BARE_FFMPEG_PACKET_HEADER_OFFSET
+const FIELDS_OFFSET = binding.BARE_FFMPEG_PACKET_FIELDS_OFFSET
 
 module.exports = class FFmpegPacket {
-  constructor(buffer) {
-    if (buffer) {
+  constructor(buffer, opts = {}, handle = null) {
+    const { copy = true } = opts
+
+    if (handle) {
+      this._handle = handle
+    } else if (buffer && copy) {
       this._handle = binding.initPacketFromBuffer(
         buffer.buffer,
         buffer.byteOffset,
@@ -12,12 +20,37 @@ module.exports = class FFmpegPacket {
       )
     } else {
       this._handle = binding.initPacket()
+
+      if (buffer) this.wrap(buffer)
     }
+
+    // Mirrors of the native packet header, kept in sync by the binding
+    this._timestamps = new Float64Array(this._handle, HEADER_OFFSET, 3)
+    this._fields = new Int32Array(this._handle, FIELDS_OFFSET, 5)
+
+    // Asynchronous reads that will deliver into the packet
+    this._pending = 0
+  }
+
+  static PADDING_SIZE = binding.AV_INPUT_BUFFER_PADDING_SIZE
+
+  static from(handle) {
+    return new FFmpegPacket(null, {}, handle)
+  }
+
+  wrap(buffer) {
+    binding.wrapPacket(this._handle, buffer.buffer, buffer.byteOffset, buffer.byteLength)
   }
 
   destroy() {
+    if (this._pending > 0) {
+      throw errors.OPERATION_PENDING('Packet has pending asynchronous reads')
+    }
+
     binding.destroyPacket(this._handle)
     this._handle = null
+    this._timestamps = null
+    this._fields = null
   }
 
   unref() {
@@ -25,7 +58,7 @@ module.exports = class FFmpegPacket {
   }
 
   get streamIndex() {
-    return binding.getPacketStreamIndex(this._handle)
+    return this._fields[0]
   }
 
   set streamIndex(value) {
@@ -58,7 +91,7 @@ module.exports = class FFmpegPacket {
   }
 
   get isKeyframe() {
-    return binding.isPacketKeyframe(this._handle)
+    return (this._fields[1] & binding.AV_PKT_FLAG_KEY) !== 0
   }
 
   set isKeyframe(value) {
@@ -66,7 +99,7 @@ module.exports = class FFmpegPacket {
   }
 
   get dts() {
-    return binding.getPacketDTS(this._handle)
+    return this._timestamps[1]
   }
 
   set dts(value) {
@@ -74,7 +107,7 @@ module.exports = class FFmpegPacket {
   }
 
   get pts() {
-    return binding.getPacketPTS(this._handle)
+    return this._timestamps[0]
   }
 
   set pts(value) {
@@ -82,8 +115,7 @@ module.exports = class FFmpegPacket {
   }
 
   get timeBase() {
-    const view = new Int32Array(binding.getPacketTimeBase(this._handle))
-    return new Rational(view[0], view[1])
+    return new Rational(this._fields[3], this._fields[4])
   }
 
   set timeBase(value) {
@@ -105,7 +137,7 @@ module.exports = class FFmpegPacket {
   }
 
   get duration() {
-    return binding.getPacketDuration(this._handle)
+    return this._timestamps[2]
   }
 
   set duration(value) {
@@ -113,7 +145,7 @@ module.exports = class FFmpegPacket {
   }
 
   get flags() {
-    return binding.getPacketFlags(this._handle)
+    return this._fields[1]
   }
 
   set flags(value) {
@@ -0,0 +1,90 @@
+const binding = require('../binding')
+
+module.exports = function remux(input, output, opts = {}) {
+  const {
+    streamMap = defaultStreamMap(input, output),
+    startTime = -1,
+    duration = -1,
+    options,
+    onprogress = noop
+  } = opts
+
+  // Refuse before anything is written if either context is busy
+  input._assertIdle()
+  output._assertIdle()
+
+  output.writeHeader(options)
+
+  return new Promise((resolve, reject) => {
+    let error = null
+
+    // Both contexts are in use by the copy until it settles
+    input._pending++
+    output._pending++
+
+    const settle = () => {
+      input._pending--
+      output._pending--
+    }
+
+    try {
+      binding.remuxFormatContext(
+        input._handle,
+        output._handle,
+        Array.from(streamMap, toStreamIndex),
+        startTime,
+        duration,
+        (time, packets) => {
+          try {
+            onprogress({ time, packets })
+          } catch (err) {
+            error = err
+            return false
+          }
+
+          return true
+        },
+        (status, packets) => {
+          settle()
+
+          if (error !== null) return reject(error)
+
+          if (status < 0) return reject(new Error(binding.getErrorString(status)))
+
+          try {
+            output.writeTrailer()
+          } catch (err) {
+            return reject(err)
+          }
+
+          resolve({ packets })
+        }
+      )
+    } catch (err) {
+      settle()
+      reject(err)
+    }
+  })
+}
+
+function defaultStreamMap(input, output) {
+  if (output.streams.length > 0) {
+    return input.streams.map((stream) => (stream.index < output.streams.length ? stream.index : -1))
+  }
+
+  return input.streams.map((stream) => {
+    const target = output.createStream()
+
+    target.codecParameters.copyFrom(stream.codecParameters)
+    target.codecParameters.tag = 0
+    target.timeBase = stream.timeBase
+
+    return target.index
+  })
+}
+
+function toStreamIndex(index) {
+  return typeof index === 'number' ? index : -1
+}
+
+function noop() {}
@@ -0,0 +1,104 @@
+const binding = require('../binding')
+const constants = require('./constants')
+const errors = require('./errors')
+const Scaler = require('./scaler')
+
+module.exports = class FFmpegScalerLadder {
+  constructor(sourcePixelFormat, sourceWidth, sourceHeight, rungs, opts = {}) {
+    sourcePixelFormat = constants.toPixelFormat(sourcePixelFormat)
+
+    this._scalers = []
+    this._pending = 0
+
+    try {
+      for (const rung of rungs) {
+        // Ladder options act as defaults for every rung
+        const { format = sourcePixelFormat, width, height, ...scalerOpts } = { ...opts, ...rung }
+
+        this._scalers.push(
+          new Scaler(
+            sourcePixelFormat,
+            sourceWidth,
+            sourceHeight,
+            format,
+            width,
+            height,
+            scalerOpts
+          )
+        )
+      }
+    } catch (err) {
+      for (const scaler of this._scalers) scaler.destroy()
+
+      throw err
+    }
+
+    this._handles = this._scalers.map((scaler) => scaler._handle)
+  }
+
+  get scalers() {
+    return this._scalers
+  }
+
+  get length() {
+    return this._scalers.length
+  }
+
+  destroy() {
+    if (this._pending > 0) {
+      throw errors.OPERATION_PENDING('Scaler ladder has pending asynchronous operations')
+    }
+
+    for (const scaler of this._scalers) scaler.destroy()
+
+    this._scalers = []
+    this._handles = []
+  }
+
+  scale(source, targets) {
+    for (const scaler of this._scalers) scaler._assertIdle()
+
+    binding.scaleScalerLadder(source._handle, this._handles, this._targetHandles(targets))
+  }
+
+  scaleAsync(source, targets) {
+    const handles = this._targetHandles(targets)
+
+    if (handles.length === 0) return Promise.resolve()
+
+    return new Promise((resolve, reject) => {
+      binding.scaleScalerLadderAsync(
+        source._handle,
+        this._handles,
+        handles,
+        Scaler.retained(targets),
+        (status) => {
+          this._pending--
+
+          for (const scaler of this._scalers) scaler._pending--
+
+          if (status < 0) reject(new Error(binding.getErrorString(status)))
+          else resolve()
+        }
+      )
+
+      this._pending++
+
+      for (const scaler of this._scalers) scaler._pending++
+    })
+  }
+
+  _targetHandles(targets) {
+    if (targets.length !== this._scalers.length) {
+      throw new RangeError(
+        `Expected ${this._scalers.length} target frames, received ${targets.length}`
+      )
+    }
+
+    return targets.map((target) => target._handle)
+  }
+
+  [Symbol.dispose]() {
+    this.destroy()
+  }
+}
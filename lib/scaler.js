@@ -1,5 +1,6 @@
 const binding = require('../binding')
 const constants = require('./constants')
+const errors = require('./errors')
 
 module.exports = class FFmpegScaler {
   constructor(
@@ -8,8 +9,19 @@ module.exports = class FFmpegScaler {
     sourceHeight,
     targetPixelFormat,
     targetWidth,
-    targetHeight
+    targetHeight,
+    opts = {}
   ) {
+    const {
+      threads = 1,
+      algorithm = constants.scalerAlgorithms.BICUBIC,
+      flags = 0,
+      sourceRange,
+      targetRange,
+      sourceMatrix,
+      targetMatrix
+    } = opts
+
     sourcePixelFormat = constants.toPixelFormat(sourcePixelFormat)
     targetPixelFormat = constants.toPixelFormat(targetPixelFormat)
 
@@ -19,6 +31,10 @@ module.exports = class FFmpegScaler {
     this._targetPixelFormat = targetPixelFormat
     this._targetWidth = targetWidth
     this._targetHeight = targetHeight
+    this._threads = threads
+    this._algorithm = toScalerAlgorithm(algorithm)
+    this._flags = flags
+    this._pending = 0
 
     this._handle = binding.initScaler(
       sourcePixelFormat,
@@ -26,18 +42,57 @@ module.exports = class FFmpegScaler {
       sourceHeight,
       targetPixelFormat,
       targetWidth,
-      targetHeight
+      targetHeight,
+      this._algorithm | flags,
+      threads
     )
+
+    if (
+      sourceRange !== undefined ||
+      targetRange !== undefined ||
+      sourceMatrix !== undefined ||
+      targetMatrix !== undefined
+    ) {
+      binding.setScalerColorspaceDetails(
+        this._handle,
+        sourceMatrix === undefined ? constants.colorSpace.UNSPECIFIED : sourceMatrix,
+        sourceRange === constants.colorRange.JPEG,
+        targetMatrix === undefined ? constants.colorSpace.UNSPECIFIED : targetMatrix,
+        targetRange === constants.colorRange.JPEG
+      )
+    }
+  }
+
+  get threads() {
+    return this._threads
+  }
+
+  get algorithm() {
+    return this._algorithm
+  }
+
+  get flags() {
+    return this._flags
   }
 
   destroy() {
+    this._assertIdle()
+
     binding.destroyScaler(this._handle)
     this._handle = null
   }
 
   scale(source, y, height, target) {
+    this._assertIdle()
+
     if (typeof y !== 'number') {
       target = y
+
+      // Only whole frames can be split across threads
+      if (this._threads !== 1) {
+        return binding.scaleScalerFrame(this._handle, source._handle, target._handle)
+      }
+
       y = 0
       height = source.height
     } else if (typeof height !== 'number') {
@@ -48,7 +103,62 @@ module.exports = class FFmpegScaler {
     return binding.scaleScaler(this._handle, source._handle, y, height, target._handle)
   }
 
+  scaleAsync(source, target) {
+    return new Promise((resolve, reject) => {
+      binding.scaleScalerAsync(
+        this._handle,
+        source._handle,
+        target._handle,
+        retained([target]),
+        (status) => {
+          this._pending--
+
+          if (status < 0) reject(new Error(binding.getErrorString(status)))
+          else resolve(status)
+        }
+      )
+
+      this._pending++
+    })
+  }
+
+  _assertIdle() {
+    if (this._pending > 0) {
+      throw errors.OPERATION_PENDING('Scaler has pending asynchronous operations')
+    }
+  }
+
   [Symbol.dispose]() {
     this.destroy()
   }
 }
+
+// The memory aliased by the given target frames, which must outlive an
+// asynchronous scale
+function retained(targets) {
+  const memory = []
+
+  for (const target of targets) {
+    if (target._memory !== null) memory.push(target._memory)
+  }
+
+  return memory
+}
+
+module.exports.retained = retained
+
+function toScalerAlgorithm(algorithm) {
+  if (typeof algorithm === 'number') return algorithm
+
+  if (typeof algorithm === 'string') {
+    const value = constants.scalerAlgorithms[algorithm.toUpperCase().replace(/-/g, '_')]
+
+    if (value !== undefined) return value
+
+    throw new Error(`Unknown scaler algorithm '${algorithm}'`)
+  }
+
+  throw new TypeError(
+    `Scaler algorithm must be a number or string. Received ${typeof algorithm} (${algorithm})`
+  )
+}
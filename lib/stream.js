@@ -59,6 +59,26 @@ module.exports = class FFmpegStream {
     return binding.getStreamDuration(this._handle)
   }
 
+  get indexEntries() {
+    const view = new BigInt64Array(binding.getStreamIndexEntries(this._handle))
+    const entries = []
+
+    for (let i = 0; i < view.length; i += 5) {
+      entries.push(toIndexEntry(view, i))
+    }
+
+    return entries
+  }
+
+  findIndexEntry(timestamp, opts = {}) {
+    const { flags = 0 } = opts
+
+    const data = binding.searchStreamIndexEntry(this._handle, timestamp, flags)
+    if (!data) return null
+
+    return toIndexEntry(new BigInt64Array(data), 0)
+  }
+
   set duration(value) {
     binding.setStreamDuration(this._handle, value)
   }
@@ -89,3 +109,13 @@ module.exports = class FFmpegStream {
 }
 
 module.exports.SideData = PacketSideData
+
+function toIndexEntry(view, i) {
+  return {
+    timestamp: Number(view[i]),
+    position: Number(view[i + 1]),
+    size: Number(view[i + 2]),
+    minDistance: Number(view[i + 3]),
+    isKeyFrame: (Number(view[i + 4]) & binding.AVINDEX_KEYFRAME) !== 0
+  }
+}
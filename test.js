@@ -1,4 +1,5 @@
 require('./test/audio-fifo')
+require('./test/bitstream-filter')
 require('./test/codec-config')
 require('./test/codec-context')
 require('./test/codec-parameters')
@@ -14,14 +15,17 @@ require('./test/filter-context')
 require('./test/filter-graph')
 require('./test/filter-inout')
 require('./test/frame')
+require('./test/frame-pool')
 require('./test/hw-device-context')
 require('./test/hw-frames-context')
 require('./test/hw-frames-constraints')
 require('./test/image')
 require('./test/input-format')
 require('./test/packet')
+require('./test/packet-pool')
 require('./test/resampler')
 require('./test/samples')
+require('./test/scaler-ladder')
 require('./test/stream')
 require('./test/log')
 require('./test/output-format')
@@ -0,0 +1,93 @@
+const test = require('brittle')
+const ffmpeg = require('..')
+
+test('bitstream filter should convert H.264 to Annex B', (t) => {
+  const video = require('./fixtures/video/sample.mp4', {
+    with: { type: 'binary' }
+  })
+
+  using io = new ffmpeg.IOContext(video)
+  using format = new ffmpeg.InputFormatContext(io)
+  const stream = format.getBestStream(ffmpeg.constants.mediaTypes.VIDEO)
+
+  using bsf = new ffmpeg.BitstreamFilter('h264_mp4toannexb')
+  bsf.open(stream)
+
+  t.is(bsf.outputParameters.id, stream.codecParameters.id)
+  t.alike(bsf.outputTimeBase, stream.timeBase)
+
+  using packet = new ffmpeg.Packet()
+  using filtered = new ffmpeg.Packet()
+
+  while (format.readFrame(packet)) {
+    if (packet.streamIndex !== stream.index) {
+      packet.unref()
+      continue
+    }
+
+    t.ok(bsf.sendPacket(packet))
+    t.is(packet.data.byteLength, 0, 'packet is consumed')
+    break
+  }
+
+  t.ok(bsf.receivePacket(filtered))
+  t.alike(Array.from(filtered.data.subarray(0, 4)), [0, 0, 0, 1])
+  t.is(filtered.streamIndex, stream.index)
+})
+
+test('bitstream filter output parameters should not outlive the filter', (t) => {
+  using format = getInputFormatContext()
+  const stream = format.getBestStream(ffmpeg.constants.mediaTypes.VIDEO)
+
+  const bsf = new ffmpeg.BitstreamFilter('null')
+  bsf.open(stream)
+
+  const parameters = bsf.outputParameters
+  t.is(parameters.width, 640)
+
+  bsf.destroy()
+
+  t.exception(() => parameters.width)
+})
+
+test('bitstream filter should accept a chain', (t) => {
+  using bsf = new ffmpeg.BitstreamFilter('null,null')
+  t.ok(bsf instanceof ffmpeg.BitstreamFilter)
+})
+
+test('bitstream filter should throw on unknown filters', (t) => {
+  t.exception(() => new ffmpeg.BitstreamFilter('not_a_filter'))
+})
+
+test('bitstream filter should drain after the end of stream', (t) => {
+  using format = getInputFormatContext()
+  const stream = format.getBestStream(ffmpeg.constants.mediaTypes.VIDEO)
+
+  using bsf = new ffmpeg.BitstreamFilter('null')
+  bsf.open(stream.codecParameters, stream.timeBase)
+
+  using packet = new ffmpeg.Packet()
+  format.readFrame(packet)
+
+  t.ok(bsf.sendPacket(packet))
+  t.ok(bsf.sendPacket())
+
+  using filtered = new ffmpeg.Packet()
+  t.ok(bsf.receivePacket(filtered))
+  t.absent(bsf.receivePacket(filtered))
+
+  bsf.flush()
+})
+
+// Helpers
+
+function getInputFormatContext() {
+  const options = new ffmpeg.Dictionary()
+  options.set('framerate', '30')
+  options.set('video_size', '640x480')
+  return new ffmpeg.InputFormatContext(
+    new ffmpeg.InputFormat('lavfi'),
+    options,
+    'testsrc=size=640x480:rate=30'
+  )
+}
@@ -130,6 +130,105 @@ test('receivePacket should return false when no frame has been sent', (t) => {
   t.absent(codecCtx.receivePacket(packet))
 })
 
+test('codec context should encode asynchronously', async (t) => {
+  using codecCtx = new ffmpeg.CodecContext(ffmpeg.Codec.AV1.encoder)
+  setDefaultOptions(codecCtx)
+  codecCtx.open(getEncoderOptions())
+  using frame = fakeFrame()
+
+  t.ok(await codecCtx.sendFrameAsync(frame))
+  t.ok(await codecCtx.sendFrameAsync(null))
+
+  using packet = new ffmpeg.Packet()
+  t.ok(await codecCtx.receivePacketAsync(packet))
+  t.ok(packet.data.length > 0)
+})
+
+test('codec context encode queue should deliver packets through an async iterator', async (t) => {
+  using codecCtx = new ffmpeg.CodecContext(ffmpeg.Codec.AV1.encoder)
+  setDefaultOptions(codecCtx)
+  codecCtx.open(getEncoderOptions())
+  using frame = fakeFrame()
+
+  const queue = codecCtx.encodeQueue({ capacity: 2 })
+
+  let writable = true
+  for (let i = 0; i < 4 && writable; i++) {
+    frame.pts = i
+    writable = queue.write(frame)
+  }
+
+  t.absent(writable, 'signals backpressure when full')
+
+  queue.end()
+
+  const timestamps = []
+  for await (const packet of queue) {
+    t.ok(packet.data.length > 0)
+    timestamps.push(packet.pts)
+    packet.destroy()
+  }
+
+  t.ok(timestamps.length > 0)
+  t.is(new Set(timestamps).size, timestamps.length, 'reusing the frame does not alter queued ones')
+})
+
+test('codec context encode queue should drain when an encode fails', async (t) => {
+  using codecCtx = new ffmpeg.CodecContext(ffmpeg.Codec.AAC.encoder)
+  codecCtx.sampleFormat = ffmpeg.constants.sampleFormats.FLTP
+  codecCtx.sampleRate = 48000
+  codecCtx.channelLayout = ffmpeg.constants.channelLayouts.STEREO
+  codecCtx.timeBase = new ffmpeg.Rational(1, 48000)
+  codecCtx.open()
+
+  // More samples than the encoder frame size is rejected by avcodec_send_frame()
+  using frame = new ffmpeg.Frame()
+  frame.format = ffmpeg.constants.sampleFormats.FLTP
+  frame.channelLayout = ffmpeg.constants.channelLayouts.STEREO
+  frame.nbSamples = codecCtx.frameSize * 4
+  frame.alloc()
+
+  const drained = new Promise((resolve) => {
+    const queue = codecCtx.encodeQueue({ capacity: 1, ondrain: () => resolve(queue) })
+
+    t.absent(queue.write(frame), 'signals backpressure when full')
+  })
+
+  const queue = await drained
+
+  t.exception(() => queue.write(frame), 'next write surfaces the error')
+})
+
+test('codec context should expose thread count and type', (t) => {
+  using codecCtx = new ffmpeg.CodecContext(ffmpeg.Codec.H264.decoder)
+
+  codecCtx.threadCount = 2
+  codecCtx.threadType = ffmpeg.constants.threadTypes.SLICE
+
+  t.is(codecCtx.threadCount, 2)
+  t.is(codecCtx.threadType, ffmpeg.constants.threadTypes.SLICE)
+})
+
+test('codec context setThreading should validate against codec capabilities', (t) => {
+  using decoder = new ffmpeg.CodecContext(ffmpeg.Codec.H264.decoder)
+
+  decoder.setThreading({ threading: 'frame', threads: 4 })
+  t.is(decoder.threadType, ffmpeg.constants.threadTypes.FRAME)
+  t.is(decoder.threadCount, 4)
+
+  decoder.setThreading({ threading: 'slice' })
+  t.is(decoder.threadType, ffmpeg.constants.threadTypes.SLICE)
+
+  decoder.open()
+
+  t.exception(() => decoder.setThreading({ threading: 'slice' }), /ALREADY_OPENED/)
+
+  using encoder = new ffmpeg.CodecContext(ffmpeg.Codec.AAC.encoder)
+
+  t.exception(() => encoder.setThreading({ threading: 'frame' }), /UNSUPPORTED_THREADING/)
+  t.exception(() => encoder.setThreading({ threading: 'bogus' }), TypeError)
+})
+
 test('codec context should expose framerate', (t) => {
   using codecCtx = new ffmpeg.CodecContext(ffmpeg.Codec.AV1.encoder)
 
@@ -227,6 +326,116 @@ test('CodecContext getFormat callback should expose pixelFormats as an Array', (
   decodeOnce()
 })
 
+test('CodecContext should decode asynchronously', async (t) => {
+  const image = require('./fixtures/image/sample.jpeg', { with: { type: 'binary' } })
+
+  using io = new ffmpeg.IOContext(image)
+  using format = new ffmpeg.InputFormatContext(io)
+  using packet = new ffmpeg.Packet()
+  using frame = new ffmpeg.Frame()
+
+  format.readFrame(packet)
+
+  using decoder = format.streams[0].decoder()
+  decoder.open()
+
+  const sent = decoder.sendPacketAsync(packet)
+  packet.unref()
+
+  t.ok(await sent)
+  t.ok(await decoder.receiveFrameAsync(frame))
+  t.ok(frame.width > 0)
+  t.ok(frame.height > 0)
+})
+
+test('CodecContext should decode into pooled buffers', (t) => {
+  const image = require('./fixtures/image/sample.jpeg', { with: { type: 'binary' } })
+
+  using io = new ffmpeg.IOContext(image)
+  using format = new ffmpeg.InputFormatContext(io)
+  using packet = new ffmpeg.Packet()
+  using frame = new ffmpeg.Frame()
+
+  format.readFrame(packet)
+
+  using decoder = format.streams[0].decoder()
+  decoder.useBufferPool()
+  decoder.open()
+
+  t.ok(decoder.sendPacket(packet))
+  t.ok(decoder.receiveFrame(frame))
+
+  const planes = frame.planes
+  t.ok(planes.length > 0)
+  t.ok(planes[0].byteLength >= frame.width * frame.height)
+
+  const luma = planes[0][0]
+  frame.unref()
+
+  t.is(planes[0][0], luma, 'planes outlive the frame')
+})
+
+test('CodecContext should flush decoder buffers', (t) => {
+  const image = require('./fixtures/image/sample.jpeg', { with: { type: 'binary' } })
+
+  using io = new ffmpeg.IOContext(image)
+  using format = new ffmpeg.InputFormatContext(io)
+  using packet = new ffmpeg.Packet()
+  using frame = new ffmpeg.Frame()
+
+  format.readFrame(packet)
+
+  using decoder = format.streams[0].decoder()
+  decoder.open()
+  decoder.sendPacket(packet)
+  decoder.flush()
+
+  t.absent(decoder.receiveFrame(frame))
+})
+
+test('CodecContext should refuse synchronous calls with pending operations', async (t) => {
+  const image = require('./fixtures/image/sample.jpeg', { with: { type: 'binary' } })
+
+  using io = new ffmpeg.IOContext(image)
+  using format = new ffmpeg.InputFormatContext(io)
+  using packet = new ffmpeg.Packet()
+  using frame = new ffmpeg.Frame()
+
+  format.readFrame(packet)
+
+  using decoder = format.streams[0].decoder()
+  decoder.open()
+
+  const sent = decoder.sendPacketAsync(packet)
+
+  t.exception(() => decoder.destroy(), /OPERATION_PENDING/)
+  t.exception(() => decoder.sendPacket(packet), /OPERATION_PENDING/)
+  t.exception(() => decoder.receiveFrame(frame), /OPERATION_PENDING/)
+  t.exception(() => decoder.flush(), /OPERATION_PENDING/)
+  t.exception(() => (decoder.threadCount = 2), /OPERATION_PENDING/)
+  t.exception(() => (decoder.getFormat = () => 0), /OPERATION_PENDING/)
+  t.exception(() => decoder.setOption('threads', '2'), /OPERATION_PENDING/)
+  t.exception(() => decoder.useBufferPool(), /OPERATION_PENDING/)
+
+  await sent
+
+  t.ok(await decoder.receiveFrameAsync(frame))
+})
+
+test('CodecContext async failures should carry the error code', async (t) => {
+  using decoder = new ffmpeg.CodecContext(ffmpeg.Codec.MJPEG.decoder)
+  using frame = new ffmpeg.Frame()
+
+  // Receiving from a decoder that was never opened fails with AVERROR(EINVAL)
+  try {
+    await decoder.receiveFrameAsync(frame)
+    t.fail('should reject')
+  } catch (err) {
+    t.ok(err.errno < 0, 'carries the negative error code')
+    t.is(err.code, err.errno)
+  }
+})
+
 test('CodecContext can get an option', (t) => {
   using codecCtx = new ffmpeg.CodecContext(ffmpeg.Codec.AV1.encoder)
 
@@ -1,4 +1,5 @@
 const test = require('brittle')
+const os = require('bare-os')
 const ffmpeg = require('..')
 
 const fallbackName = 'lavfi'
@@ -83,6 +84,159 @@ test('InputFormatContext.duration should expose the container duration', (t) =>
   t.is(inputFormatContext.duration, 4000000)
 })
 
+test('InputFormatContext.seek should jump to a keyframe', (t) => {
+  const video = require('./fixtures/video/sample.mp4', {
+    with: { type: 'binary' }
+  })
+
+  using io = new ffmpeg.IOContext(video)
+  using inputFormatContext = new ffmpeg.InputFormatContext(io)
+  using packet = new ffmpeg.Packet()
+
+  const stream = inputFormatContext.getBestStream(ffmpeg.constants.mediaTypes.VIDEO)
+  const timestamp = Math.floor(stream.duration / 2)
+
+  inputFormatContext.seek(stream.index, timestamp, {
+    flags: ffmpeg.constants.seekFlags.BACKWARD
+  })
+
+  while (inputFormatContext.readFrame(packet)) {
+    if (packet.streamIndex === stream.index) break
+    packet.unref()
+  }
+
+  t.ok(packet.isKeyFrame)
+  t.ok(packet.pts <= timestamp)
+})
+
+test('InputFormatContext.readFrames should read packets in batches', (t) => {
+  const audio = require('./fixtures/audio/sample.mp3', {
+    with: { type: 'binary' }
+  })
+
+  using io = new ffmpeg.IOContext(audio)
+  using inputFormatContext = new ffmpeg.InputFormatContext(io)
+
+  const packets = Array.from({ length: 16 }, () => new ffmpeg.Packet())
+
+  const metadata = inputFormatContext.readFrames(packets)
+  t.is(metadata.length, 16 * 6)
+
+  for (let i = 0; i < 16; i++) {
+    t.is(metadata[i * 6], packets[i].streamIndex)
+    t.is(metadata[i * 6 + 1], packets[i].pts)
+    t.is(metadata[i * 6 + 5], packets[i].data.byteLength)
+  }
+
+  let total = 16
+  let batch
+  while ((batch = inputFormatContext.readFrames(packets)).length > 0) total += batch.length / 6
+
+  t.ok(total > 16)
+
+  for (const packet of packets) packet.destroy()
+})
+
+test('InputFormatContext.readFrameAsync should match readFrame', async (t) => {
+  const audio = require('./fixtures/audio/sample.mp3', {
+    with: { type: 'binary' }
+  })
+
+  using blocking = new ffmpeg.InputFormatContext(new ffmpeg.IOContext(audio))
+  using pooled = await ffmpeg.InputFormatContext.openAsync(new ffmpeg.IOContext(audio))
+
+  t.is(pooled.streams.length, blocking.streams.length)
+
+  using expected = new ffmpeg.Packet()
+  using actual = new ffmpeg.Packet()
+
+  let packets = 0
+
+  const pending = pooled.readFrameAsync(actual)
+
+  t.exception(() => pooled.destroy(), /OPERATION_PENDING/)
+  t.ok(await pending)
+
+  while (blocking.readFrame(expected)) {
+    if (packets > 0) t.ok(await pooled.readFrameAsync(actual))
+
+    t.is(actual.pts, expected.pts)
+    t.alike(actual.data, expected.data)
+
+    packets++
+  }
+
+  t.absent(await pooled.readFrameAsync(actual))
+  t.ok(packets > 0)
+})
+
+test('InputFormatContext.openAsync should reject JavaScript I/O callbacks', async (t) => {
+  const io = new ffmpeg.IOContext(4096, {
+    onread: () => 0
+  })
+
+  await t.exception(ffmpeg.InputFormatContext.openAsync(io), /JavaScript I\/O callbacks/)
+})
+
+test('InputFormatContext should open from the container headers alone', async (t) => {
+  const video = require('./fixtures/video/sample.mp4', {
+    with: { type: 'binary' }
+  })
+
+  using probed = new ffmpeg.InputFormatContext(new ffmpeg.IOContext(video))
+  using fast = new ffmpeg.InputFormatContext(new ffmpeg.IOContext(video), {
+    skipStreamInfo: true
+  })
+  using pooled = await ffmpeg.InputFormatContext.openAsync(new ffmpeg.IOContext(video), {
+    probesize: 32768,
+    analyzeduration: 0,
+    skipStreamInfo: true
+  })
+
+  t.is(fast.streams.length, probed.streams.length)
+  t.is(pooled.streams.length, probed.streams.length)
+
+  for (let i = 0; i < probed.streams.length; i++) {
+    const expected = probed.streams[i].codecParameters
+
+    t.is(fast.streams[i].codecParameters.id, expected.id)
+    t.is(fast.streams[i].codecParameters.width, expected.width)
+    t.is(pooled.streams[i].codecParameters.id, expected.id)
+  }
+
+  using packet = new ffmpeg.Packet()
+
+  t.ok(fast.readFrame(packet))
+})
+
+test('InputFormatContext.openAsync should time out on a stalled input', async (t) => {
+  const io = ffmpeg.IOContext.stream()
+
+  await t.exception(ffmpeg.InputFormatContext.openAsync(io, { timeoutMs: 50 }), /TIMEOUT/)
+})
+
+test('InputFormatContext.abort should interrupt a pending read', async (t) => {
+  const audio = require('./fixtures/audio/sample.mp3', {
+    with: { type: 'binary' }
+  })
+
+  const io = ffmpeg.IOContext.stream()
+
+  // Never ended, so the last read waits for more data until aborted
+  io.push(audio)
+
+  using format = await ffmpeg.InputFormatContext.openAsync(io)
+  using packet = new ffmpeg.Packet()
+
+  await t.exception(async () => {
+    while (await format.readFrameAsync(packet)) {
+      packet.unref()
+
+      if (io.buffered === 0) format.abort()
+    }
+  }, /ABORTED/)
+})
+
 // OutputFormatContext
 
 test('OutputFormatContext should expose an outputFormat getter', (t) => {
@@ -94,8 +248,155 @@ test('OutputFormatContext should expose an outputFormat getter', (t) => {
   t.ok(outputFormat instanceof ffmpeg.OutputFormat)
 })
 
+// remux
+
+test('remux should copy every stream into the output', async (t) => {
+  const video = require('./fixtures/video/sample.mp4', {
+    with: { type: 'binary' }
+  })
+
+  const chunks = []
+
+  using input = new ffmpeg.InputFormatContext(new ffmpeg.IOContext(video))
+  using output = new ffmpeg.OutputFormatContext(
+    'matroska',
+    new ffmpeg.IOContext(4096, { onwrite: (chunk) => chunks.push(Buffer.from(chunk)) })
+  )
+
+  let progress = null
+
+  const result = await ffmpeg.remux(input, output, {
+    onprogress(update) {
+      progress = update
+    }
+  })
+
+  t.is(output.streams.length, input.streams.length)
+  t.ok(result.packets > 0)
+  t.ok(progress === null || progress.packets <= result.packets)
+
+  using remuxed = new ffmpeg.InputFormatContext(new ffmpeg.IOContext(Buffer.concat(chunks)))
+  using packet = new ffmpeg.Packet()
+
+  let packets = 0
+  while (remuxed.readFrame(packet)) packets++
+
+  t.is(packets, result.packets)
+})
+
+test('remux should write a file natively', async (t) => {
+  const video = require('./fixtures/video/sample.mp4', {
+    with: { type: 'binary' }
+  })
+
+  const path = os.tmpdir() + '/bare-ffmpeg-remux.mp4'
+
+  using input = new ffmpeg.InputFormatContext(new ffmpeg.IOContext(video))
+
+  const result = await (async () => {
+    using output = new ffmpeg.OutputFormatContext('mp4', path)
+
+    // Wait for the trailer before the output is closed
+    return await ffmpeg.remux(input, output)
+  })()
+
+  using remuxed = new ffmpeg.InputFormatContext(new ffmpeg.IOContext(path))
+  using packet = new ffmpeg.Packet()
+
+  t.is(remuxed.streams.length, input.streams.length)
+
+  let packets = 0
+  while (remuxed.readFrame(packet)) packets++
+
+  t.is(packets, result.packets)
+})
+
+test('remux should honour the stream map and time range', async (t) => {
+  const video = require('./fixtures/video/sample.mp4', {
+    with: { type: 'binary' }
+  })
+
+  using input = new ffmpeg.InputFormatContext(new ffmpeg.IOContext(video))
+  using output = new ffmpeg.OutputFormatContext(
+    'matroska',
+    new ffmpeg.IOContext(4096, { onwrite: () => {} })
+  )
+
+  const source = input.getBestStream(ffmpeg.constants.mediaTypes.VIDEO)
+  const target = output.createStream()
+  target.codecParameters.copyFrom(source.codecParameters)
+  target.codecParameters.tag = 0
+  target.timeBase = source.timeBase
+
+  const streamMap = input.streams.map((stream) => (stream === source ? target.index : -1))
+
+  const all = countPackets(video, source.index)
+
+  const result = await ffmpeg.remux(input, output, {
+    streamMap,
+    startTime: 0,
+    duration: 500000
+  })
+
+  t.ok(result.packets > 0)
+  t.ok(result.packets < all)
+})
+
+test('remux should refuse other operations on its contexts until it settles', async (t) => {
+  const video = require('./fixtures/video/sample.mp4', {
+    with: { type: 'binary' }
+  })
+
+  const path = os.tmpdir() + '/bare-ffmpeg-remux-pending.mkv'
+
+  using input = new ffmpeg.InputFormatContext(new ffmpeg.IOContext(video))
+  using output = new ffmpeg.OutputFormatContext('matroska', path)
+  using packet = new ffmpeg.Packet()
+
+  const remuxing = ffmpeg.remux(input, output)
+
+  t.exception(() => input.readFrame(packet), /OPERATION_PENDING/)
+  t.exception(() => output.writeFrame(packet), /OPERATION_PENDING/)
+  t.exception(() => input.destroy(), /OPERATION_PENDING/)
+
+  await remuxing
+
+  t.absent(input.readFrame(packet))
+})
+
+test('remux should refuse an input with a pending read', async (t) => {
+  const video = require('./fixtures/video/sample.mp4', {
+    with: { type: 'binary' }
+  })
+
+  using input = new ffmpeg.InputFormatContext(new ffmpeg.IOContext(video))
+  using output = new ffmpeg.OutputFormatContext(
+    'matroska',
+    new ffmpeg.IOContext(4096, { onwrite: () => t.fail('header written') })
+  )
+  using packet = new ffmpeg.Packet()
+
+  const reading = input.readFrameAsync(packet)
+
+  t.exception(() => ffmpeg.remux(input, output), /OPERATION_PENDING/)
+
+  t.ok(await reading)
+})
+
 // Helpers
 
+function countPackets(buffer, streamIndex) {
+  using format = new ffmpeg.InputFormatContext(new ffmpeg.IOContext(buffer))
+  using packet = new ffmpeg.Packet()
+
+  let count = 0
+  while (format.readFrame(packet)) {
+    if (packet.streamIndex === streamIndex) count++
+  }
+
+  return count
+}
+
 function getOptions() {
   const options = new ffmpeg.Dictionary()
   options.set('framerate', '30')
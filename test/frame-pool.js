@@ -0,0 +1,80 @@
+const test = require('brittle')
+const ffmpeg = require('..')
+
+test('frame pool should hand out video frames', (t) => {
+  using pool = new ffmpeg.FramePool({
+    format: ffmpeg.constants.pixelFormats.YUV420P,
+    width: 64,
+    height: 48
+  })
+
+  const frame = pool.get()
+
+  t.is(frame.width, 64)
+  t.is(frame.height, 48)
+  t.is(frame.format, ffmpeg.constants.pixelFormats.YUV420P)
+
+  pool.release(frame)
+
+  t.is(frame.width, 0)
+  t.is(pool.get(), frame, 'recycles released frames')
+
+  pool.release(frame)
+})
+
+test('frame pool should hand out audio frames', (t) => {
+  using pool = new ffmpeg.FramePool({
+    sampleFormat: ffmpeg.constants.sampleFormats.FLTP,
+    channelLayout: ffmpeg.constants.channelLayouts.STEREO,
+    nbSamples: 1024
+  })
+
+  using frame = new ffmpeg.Frame()
+  pool.get(frame)
+
+  t.is(frame.nbSamples, 1024)
+  t.is(frame.format, ffmpeg.constants.sampleFormats.FLTP)
+  t.is(frame.channelLayout.nbChannels, 2)
+})
+
+test('frame pool frames should be encodable', (t) => {
+  using pool = new ffmpeg.FramePool({
+    format: ffmpeg.constants.pixelFormats.YUV420P,
+    width: 64,
+    height: 48
+  })
+
+  using encoder = new ffmpeg.CodecContext(ffmpeg.Codec.MJPEG.encoder)
+  encoder.width = 64
+  encoder.height = 48
+  encoder.pixelFormat = ffmpeg.constants.pixelFormats.YUVJ420P
+  encoder.timeBase = new ffmpeg.Rational(1, 30)
+  encoder.open()
+
+  using packet = new ffmpeg.Packet()
+
+  for (let i = 0; i < 4; i++) {
+    const frame = pool.get()
+    frame.format = ffmpeg.constants.pixelFormats.YUVJ420P
+    frame.pts = i
+
+    t.ok(encoder.sendFrame(frame))
+    pool.release(frame)
+
+    t.ok(encoder.receivePacket(packet))
+    packet.unref()
+  }
+})
+
+test('frame pool should outlive destroy while frames are in use', (t) => {
+  const pool = new ffmpeg.FramePool({
+    format: ffmpeg.constants.pixelFormats.RGB24,
+    width: 16,
+    height: 16
+  })
+
+  using frame = pool.get()
+  pool.destroy()
+
+  t.is(frame.width, 16)
+})
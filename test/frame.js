@@ -132,6 +132,106 @@ test('copy frame properties', (t) => {
   t.ok(b.sideData[0].data.equals(a.sideData[0].data))
 })
 
+test('frame metadata should follow native updates', (t) => {
+  using frame = new ffmpeg.Frame()
+  frame.width = 64
+  frame.height = 32
+  frame.format = ffmpeg.constants.pixelFormats.RGB24
+  frame.pts = 42
+  frame.alloc()
+
+  t.is(frame.width, 64)
+  t.is(frame.height, 32)
+  t.is(frame.pts, 42)
+
+  frame.unref()
+
+  t.is(frame.width, 0)
+  t.is(frame.height, 0)
+  t.is(frame.format, -1)
+  t.is(frame.pts, -1)
+})
+
+test('frame should expose its planes without copying', (t) => {
+  using frame = new ffmpeg.Frame()
+  frame.width = 64
+  frame.height = 32
+  frame.format = ffmpeg.constants.pixelFormats.YUV420P
+  frame.alloc()
+
+  const planes = frame.planes
+  t.is(planes.length, 3)
+  t.ok(planes[0].byteLength >= 64 * 32)
+  t.ok(planes[1].byteLength >= 32 * 16)
+
+  planes[0].fill(42)
+  t.is(frame.planes[0][0], 42)
+})
+
+test('frame should expose linesize and single planes', (t) => {
+  using frame = new ffmpeg.Frame()
+  frame.width = 64
+  frame.height = 32
+  frame.format = ffmpeg.constants.pixelFormats.YUV420P
+  frame.alloc()
+
+  const linesize = frame.linesize
+  t.ok(linesize[0] >= 64)
+  t.ok(linesize[1] >= 32)
+  t.is(linesize[3], 0)
+
+  const luma = frame.getPlane(0)
+  t.is(luma.byteLength, linesize[0] * 32)
+  t.is(frame.getPlane(3), null)
+
+  frame.unref()
+  t.is(frame.linesize[0], 0)
+})
+
+test('frame should wrap a buffer without copying', (t) => {
+  const buffer = Buffer.alloc(16 * 8 * 4, 7)
+
+  using frame = new ffmpeg.Frame()
+  frame.wrap(buffer, ffmpeg.constants.pixelFormats.RGBA, 16, 8)
+
+  t.is(frame.width, 16)
+  t.is(frame.height, 8)
+  t.is(frame.format, ffmpeg.constants.pixelFormats.RGBA)
+  t.is(frame.linesize[0], 64)
+
+  buffer[0] = 42
+  t.is(frame.getPlane(0)[0], 42)
+})
+
+test('frame should refuse to wrap a buffer that is too small', (t) => {
+  using frame = new ffmpeg.Frame()
+
+  t.exception(() => frame.wrap(Buffer.alloc(10), ffmpeg.constants.pixelFormats.RGBA, 16, 8))
+})
+
+test('wrapped frames should be encodable asynchronously', async (t) => {
+  const buffer = Buffer.alloc(64 * 48 * 3 / 2, 128)
+
+  using frame = new ffmpeg.Frame()
+  frame.wrap(buffer, ffmpeg.constants.pixelFormats.YUVJ420P, 64, 48)
+  frame.pts = 0
+
+  using encoder = new ffmpeg.CodecContext(ffmpeg.Codec.MJPEG.encoder)
+  encoder.width = 64
+  encoder.height = 48
+  encoder.pixelFormat = ffmpeg.constants.pixelFormats.YUVJ420P
+  encoder.timeBase = new ffmpeg.Rational(1, 30)
+  encoder.open()
+
+  const packets = encoder.encodeAsync(frame)
+  frame.unref()
+
+  const result = await packets
+  t.is(result.length, 1)
+
+  for (const packet of result) packet.destroy()
+})
+
 test('Frame sideData round-trips custom payloads', (t) => {
   using frame = new ffmpeg.Frame()
 
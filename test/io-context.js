@@ -153,6 +153,196 @@ test('IOContext streaming mp4 with onseek', (t) => {
   t.is(audio.length, 34914, `audio size: got ${audio.length}, expected 34914`)
 })
 
+test('IOContext should read and seek a file natively', (t) => {
+  using io = new ffmpeg.IOContext(__dirname + '/fixtures/video/sample.mp4')
+  using format = new ffmpeg.InputFormatContext(io)
+  using packet = new ffmpeg.Packet()
+
+  const stream = format.getBestStream(mediaTypes.VIDEO)
+  t.ok(stream)
+  t.is(format.duration, 4000000)
+
+  format.seek(stream.index, Math.floor(stream.duration / 2), {
+    flags: ffmpeg.constants.seekFlags.BACKWARD
+  })
+
+  t.ok(format.readFrame(packet))
+})
+
+test('IOContext should read a buffer in place with a small internal buffer', (t) => {
+  const data = require('./fixtures/video/sample.mp4', {
+    with: { type: 'binary' }
+  })
+
+  const padded = Buffer.alloc(data.byteLength + 16)
+  padded.set(data, 16)
+
+  using io = new ffmpeg.IOContext(padded.subarray(16), { bufferSize: 1024 })
+  using format = new ffmpeg.InputFormatContext(io)
+  using packet = new ffmpeg.Packet()
+
+  const stream = format.getBestStream(mediaTypes.VIDEO)
+  t.is(format.duration, 4000000)
+
+  format.seek(stream.index, Math.floor(stream.duration / 2), {
+    flags: ffmpeg.constants.seekFlags.BACKWARD
+  })
+
+  let packets = 0
+  while (format.readFrame(packet)) {
+    packets++
+    packet.unref()
+  }
+
+  t.ok(packets > 0)
+})
+
+test('IOContext should refuse to read a detached buffer', (t) => {
+  const data = require('./fixtures/video/sample.mp4', {
+    with: { type: 'binary' }
+  })
+
+  const copy = Buffer.from(data)
+
+  using io = new ffmpeg.IOContext(copy)
+  using format = new ffmpeg.InputFormatContext(io)
+  using packet = new ffmpeg.Packet()
+
+  copy.buffer.transfer()
+
+  t.exception(() => format.readFrame(packet), /detached/)
+})
+
+test('IOContext should throw when the file does not exist', (t) => {
+  t.exception(() => new ffmpeg.IOContext(__dirname + '/fixtures/missing.mp4'), /ENOENT/)
+})
+
+test('IOContext.stream() should demux chunks as they are pushed', async (t) => {
+  const data = require('./fixtures/video/sample.webm', {
+    with: { type: 'binary' }
+  })
+
+  const io = ffmpeg.IOContext.stream({ highWaterMark: 16384 })
+
+  // Open before any data is available, the demuxer waits on the thread pool
+  const opening = ffmpeg.InputFormatContext.openAsync(io)
+
+  const pushing = (async () => {
+    for (let offset = 0; offset < data.length; offset += 4096) {
+      io.push(data.subarray(offset, offset + 4096))
+
+      await new Promise(setImmediate)
+    }
+
+    io.end()
+  })()
+
+  using format = await opening
+  using packet = new ffmpeg.Packet()
+
+  let video = 0
+  let audio = 0
+
+  while (await format.readFrameAsync(packet)) {
+    const mediaType = format.streams[packet.streamIndex].codecParameters.type
+
+    if (mediaType === mediaTypes.VIDEO) video += packet.data.byteLength
+    else if (mediaType === mediaTypes.AUDIO) audio += packet.data.byteLength
+
+    packet.unref()
+  }
+
+  await pushing
+
+  t.is(video, 145416)
+  t.is(audio, 42419)
+  t.is(io.buffered, 0)
+  t.exception(() => io.push(Buffer.alloc(1)), /destroyed|after the end/)
+})
+
+test('IOContext.stream() should signal backpressure', async (t) => {
+  const data = require('./fixtures/video/sample.webm', {
+    with: { type: 'binary' }
+  })
+
+  t.plan(3)
+
+  const io = ffmpeg.IOContext.stream({
+    highWaterMark: 8192,
+    ondrain() {
+      t.pass('drained')
+    }
+  })
+
+  t.ok(io.push(data.subarray(0, 4096)))
+  t.absent(io.push(data.subarray(4096)))
+
+  using format = await ffmpeg.InputFormatContext.openAsync(io)
+  io.end()
+
+  using packet = new ffmpeg.Packet()
+
+  while (await format.readFrameAsync(packet)) packet.unref()
+})
+
+test('IOContext.stream() should refuse synchronous use', async (t) => {
+  const data = require('./fixtures/video/sample.webm', {
+    with: { type: 'binary' }
+  })
+
+  t.exception(
+    () => new ffmpeg.InputFormatContext(ffmpeg.IOContext.stream()),
+    /InputFormatContext.openAsync/
+  )
+
+  const io = ffmpeg.IOContext.stream()
+  io.push(data)
+  io.end()
+
+  using format = await ffmpeg.InputFormatContext.openAsync(io)
+  using packet = new ffmpeg.Packet()
+
+  t.exception(() => format.readFrame(packet), /asynchronously/)
+
+  const reading = format.readFrameAsync(packet)
+
+  t.exception(() => format.readFrames([packet]), /OPERATION_PENDING/)
+  t.exception(() => format.seek(0, 0), /OPERATION_PENDING/)
+  t.exception(() => packet.destroy(), /OPERATION_PENDING/)
+
+  t.ok(await reading)
+})
+
+test('IOContext should coalesce writes into chunks', async (t) => {
+  const video = require('./fixtures/video/sample.webm', {
+    with: { type: 'binary' }
+  })
+
+  const chunkSize = 65536
+
+  const expected = await remuxTo({})
+  const actual = await remuxTo({ writeChunkSize: chunkSize })
+
+  t.ok(actual.length < expected.length)
+  t.alike(Buffer.concat(actual), Buffer.concat(expected))
+
+  for (let i = 0; i < actual.length - 1; i++) t.is(actual[i].byteLength, chunkSize)
+
+  async function remuxTo(opts) {
+    const chunks = []
+
+    using input = new ffmpeg.InputFormatContext(new ffmpeg.IOContext(video))
+    using output = new ffmpeg.OutputFormatContext(
+      'matroska',
+      new ffmpeg.IOContext(4096, { ...opts, onwrite: (chunk) => chunks.push(chunk) })
+    )
+
+    await ffmpeg.remux(input, output)
+
+    return chunks
+  }
+})
+
 test('IOContext.transfer() should transfer ownership between IOContext instances', (t) => {
   const buffer = require('./fixtures/image/sample.jpeg', {
     with: { type: 'binary' }
@@ -0,0 +1,50 @@
+const test = require('brittle')
+const ffmpeg = require('..')
+
+test('packet pool should hand out packets of the requested size', (t) => {
+  using pool = new ffmpeg.PacketPool()
+
+  const packet = pool.acquire(1000)
+
+  t.is(packet.data.byteLength, 1000)
+
+  pool.release(packet)
+
+  t.is(packet.data.byteLength, 0)
+  t.is(pool.acquire(), packet, 'recycles released packets')
+
+  pool.release(packet)
+})
+
+test('packet pool should copy data into pooled buffers', (t) => {
+  using pool = new ffmpeg.PacketPool({ minSize: 16 })
+
+  const data = Buffer.from('hello world')
+  const packet = pool.acquire(data)
+
+  t.alike(packet.data, data)
+
+  packet.pts = 10
+  t.is(packet.pts, 10)
+
+  pool.release(packet)
+})
+
+test('packet pool should fall back for oversized packets', (t) => {
+  using pool = new ffmpeg.PacketPool({ minSize: 1 })
+
+  const packet = pool.acquire(1 << 16)
+
+  t.is(packet.data.byteLength, 1 << 16)
+
+  pool.release(packet)
+})
+
+test('packet pool packets should outlive the pool', (t) => {
+  const pool = new ffmpeg.PacketPool()
+
+  using packet = pool.acquire(Buffer.from('data'))
+  pool.destroy()
+
+  t.alike(packet.data, Buffer.from('data'))
+})
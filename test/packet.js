@@ -38,6 +38,55 @@ test('packet should copy and expose its data', (t) => {
   t.ok(buffer[3] === 0x44)
 })
 
+test('packet data should outlive the packet', (t) => {
+  const packet = new ffmpeg.Packet()
+  fillPacket(packet)
+
+  const expected = Buffer.from(packet.data)
+  const buffer = packet.data
+
+  packet.unref()
+  packet.destroy()
+
+  t.alike(buffer, expected)
+})
+
+test('packet should wrap a padded buffer without copying', (t) => {
+  const chunk = Buffer.alloc(4 + ffmpeg.Packet.PADDING_SIZE)
+  chunk.set([0x41, 0x42, 0x43, 0x44])
+
+  using packet = new ffmpeg.Packet(chunk.subarray(0, 4), { copy: false })
+
+  chunk[0] = 0x45
+
+  const buffer = packet.data
+
+  t.is(buffer.byteLength, 4)
+  t.is(buffer[0], 0x45)
+})
+
+test('packet should copy a buffer without room for padding', (t) => {
+  const chunk = Buffer.from([0x41, 0x42, 0x43, 0x44])
+
+  using packet = new ffmpeg.Packet()
+  packet.wrap(chunk)
+
+  chunk[0] = 0x45
+
+  t.is(packet.data[0], 0x41)
+})
+
+test('packet should copy a buffer followed by non-zero padding', (t) => {
+  const chunk = Buffer.alloc(4 + ffmpeg.Packet.PADDING_SIZE, 0xff)
+  chunk.set([0x41, 0x42, 0x43, 0x44])
+
+  using packet = new ffmpeg.Packet(chunk.subarray(0, 4), { copy: false })
+
+  chunk[0] = 0x45
+
+  t.is(packet.data[0], 0x41)
+})
+
 test('packet set data', (t) => {
   const inputBuffer = Buffer.from([0x41, 0x42, 0x43, 0x44])
   using packet = new ffmpeg.Packet(inputBuffer)
@@ -136,6 +185,21 @@ test('rescale packet timestamps & timebase', (t) => {
   t.is(packet.dts, 700)
 })
 
+test('packet metadata should follow native updates', (t) => {
+  using packet = new ffmpeg.Packet()
+  fillPacket(packet)
+
+  t.is(packet.streamIndex, 0)
+  t.ok(packet.isKeyframe)
+  t.ok(packet.data.byteLength > 0)
+
+  packet.unref()
+
+  t.is(packet.flags, 0)
+  t.is(packet.pts, -1)
+  t.is(packet.dts, -1)
+})
+
 test('packet should expose a sideData getter', (t) => {
   using packet = new ffmpeg.Packet()
   fillPacket(packet)
@@ -101,6 +101,7 @@ test('resampler can flush remaining samples', (t) => {
 
   const flushed = resampler.flush(outputFrame)
   t.ok(flushed >= 0, 'flush returns non-negative sample count')
+  t.is(outputFrame.nbSamples, flushed, 'frame reports the flushed sample count')
 })
 
 test('resampler with audio from aiff file', (t) => {
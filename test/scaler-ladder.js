@@ -0,0 +1,143 @@
+const test = require('brittle')
+const ffmpeg = require('..')
+
+test('scaler ladder should scale to every rung', (t) => {
+  using raw = decodeImage()
+
+  const rungs = [
+    { width: raw.width >> 1, height: raw.height >> 1 },
+    {
+      width: raw.width >> 2,
+      height: raw.height >> 2,
+      format: 'rgba',
+      algorithm: 'fast_bilinear'
+    }
+  ]
+
+  using ladder = new ffmpeg.ScalerLadder(raw.format, raw.width, raw.height, rungs)
+
+  t.is(ladder.length, 2)
+  t.is(ladder.scalers[1].algorithm, ffmpeg.constants.scalerAlgorithms.FAST_BILINEAR)
+
+  using half = allocFrame(rungs[0].width, rungs[0].height, raw.format)
+  using quarter = allocFrame(rungs[1].width, rungs[1].height, ffmpeg.constants.pixelFormats.RGBA)
+
+  ladder.scale(raw, [half, quarter])
+
+  using expected = allocFrame(rungs[1].width, rungs[1].height, ffmpeg.constants.pixelFormats.RGBA)
+
+  ladder.scalers[1].scale(raw, expected)
+
+  t.alike(quarter.getPlane(0), expected.getPlane(0))
+})
+
+test('scaler ladder should scale rungs asynchronously', async (t) => {
+  using raw = decodeImage()
+
+  const rungs = [
+    { width: raw.width >> 1, height: raw.height >> 1 },
+    { width: raw.width >> 2, height: raw.height >> 2 },
+    { width: raw.width >> 3, height: raw.height >> 3 }
+  ]
+
+  using ladder = new ffmpeg.ScalerLadder(raw.format, raw.width, raw.height, rungs, {
+    format: 'rgba'
+  })
+
+  // The first target is allocated by the ladder
+  using allocated = new ffmpeg.Frame()
+  allocated.width = rungs[0].width
+  allocated.height = rungs[0].height
+  allocated.format = ffmpeg.constants.pixelFormats.RGBA
+
+  using second = allocFrame(rungs[1].width, rungs[1].height)
+  using third = allocFrame(rungs[2].width, rungs[2].height)
+
+  const pending = ladder.scaleAsync(raw, [allocated, second, third])
+
+  t.exception(() => ladder.destroy(), /OPERATION_PENDING/)
+  t.exception(() => ladder.scalers[0].destroy(), /OPERATION_PENDING/)
+
+  await pending
+
+  t.is(allocated.width, rungs[0].width)
+  t.ok(allocated.getPlane(0))
+
+  using expected = allocFrame(rungs[2].width, rungs[2].height)
+
+  ladder.scalers[2].scale(raw, expected)
+
+  t.alike(third.getPlane(0), expected.getPlane(0))
+})
+
+test('scaler ladder should share the queue of its scalers', async (t) => {
+  using raw = decodeImage()
+
+  const rungs = [
+    { width: raw.width >> 1, height: raw.height >> 1 },
+    { width: raw.width >> 2, height: raw.height >> 2 }
+  ]
+
+  using ladder = new ffmpeg.ScalerLadder(raw.format, raw.width, raw.height, rungs, {
+    format: 'rgba'
+  })
+
+  using first = allocFrame(rungs[0].width, rungs[0].height)
+  using second = allocFrame(rungs[1].width, rungs[1].height)
+  using direct = allocFrame(rungs[1].width, rungs[1].height)
+
+  const pending = [
+    ladder.scaleAsync(raw, [first, second]),
+    ladder.scalers[1].scaleAsync(raw, direct),
+    ladder.scaleAsync(raw, [first, second])
+  ]
+
+  t.exception(() => ladder.scale(raw, [first, second]), /OPERATION_PENDING/)
+  t.exception(() => ladder.scalers[1].scale(raw, direct), /OPERATION_PENDING/)
+
+  await Promise.all(pending)
+
+  t.alike(direct.getPlane(0), second.getPlane(0))
+})
+
+test('scaler ladder should reject mismatched targets', (t) => {
+  using raw = decodeImage()
+
+  using ladder = new ffmpeg.ScalerLadder(raw.format, raw.width, raw.height, [
+    { width: 64, height: 64, format: 'rgba' }
+  ])
+
+  t.exception(() => ladder.scale(raw, []), /Expected 1 target frames/)
+})
+
+// Helpers
+
+function decodeImage() {
+  const image = require('./fixtures/image/sample.jpeg', {
+    with: { type: 'binary' }
+  })
+
+  using io = new ffmpeg.IOContext(image)
+  using format = new ffmpeg.InputFormatContext(io)
+  using packet = new ffmpeg.Packet()
+  format.readFrame(packet)
+
+  using decoder = format.streams[0].decoder()
+  decoder.open()
+  decoder.sendPacket(packet)
+
+  const frame = new ffmpeg.Frame()
+  decoder.receiveFrame(frame)
+
+  return frame
+}
+
+function allocFrame(width, height, format = ffmpeg.constants.pixelFormats.RGBA) {
+  const frame = new ffmpeg.Frame()
+  frame.width = width
+  frame.height = height
+  frame.format = format
+  frame.alloc()
+
+  return frame
+}
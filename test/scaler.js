@@ -39,3 +39,223 @@ test('it should preseve line number in case of downscale', (t) => {
     t.ok(lines === rgba.height)
   }
 })
+
+test('threaded scaling should match serial scaling', (t) => {
+  using raw = decodeImage()
+
+  const width = raw.width / 2
+  const height = raw.height / 2
+
+  using serial = allocFrame(width, height)
+  using threaded = allocFrame(width, height)
+
+  using serialScaler = new ffmpeg.Scaler(raw.format, raw.width, raw.height, 'RGBA', width, height)
+  using threadedScaler = new ffmpeg.Scaler(
+    raw.format,
+    raw.width,
+    raw.height,
+    'RGBA',
+    width,
+    height,
+    { threads: 4 }
+  )
+
+  t.is(serialScaler.scale(raw, serial), height)
+  t.is(threadedScaler.scale(raw, threaded), height)
+
+  t.alike(threaded.getPlane(0), serial.getPlane(0))
+})
+
+test('scaleAsync should scale off the JavaScript thread', async (t) => {
+  using raw = decodeImage()
+
+  const width = raw.width / 2
+  const height = raw.height / 2
+
+  using serial = allocFrame(width, height)
+  using scaler = new ffmpeg.Scaler(raw.format, raw.width, raw.height, 'RGBA', width, height, {
+    threads: 2
+  })
+
+  scaler.scale(raw, serial)
+
+  using allocated = allocFrame(width, height)
+  t.is(await scaler.scaleAsync(raw, allocated), height)
+  t.alike(allocated.getPlane(0), serial.getPlane(0))
+
+  using empty = new ffmpeg.Frame()
+  empty.width = width
+  empty.height = height
+  empty.format = ffmpeg.constants.pixelFormats.RGBA
+
+  t.is(await scaler.scaleAsync(raw, empty), height, 'allocates targets without buffers')
+  t.alike(empty.getPlane(0).subarray(0, width * 4), serial.getPlane(0).subarray(0, width * 4))
+})
+
+test('scaler should refuse to destroy with pending operations', async (t) => {
+  using raw = decodeImage()
+  using target = allocFrame(raw.width, raw.height)
+
+  const scaler = new ffmpeg.Scaler(
+    raw.format,
+    raw.width,
+    raw.height,
+    'RGBA',
+    raw.width,
+    raw.height
+  )
+
+  const pending = scaler.scaleAsync(raw, target)
+
+  t.exception(() => scaler.destroy(), /OPERATION_PENDING/)
+  t.exception(() => scaler.scale(raw, target), /OPERATION_PENDING/)
+
+  await pending
+  scaler.destroy()
+})
+
+test('scaleAsync calls should run one at a time into image targets', async (t) => {
+  using raw = decodeImage()
+
+  const width = raw.width / 2
+  const height = raw.height / 2
+
+  using scaler = new ffmpeg.Scaler(raw.format, raw.width, raw.height, 'RGBA', width, height)
+
+  using serial = allocFrame(width, height)
+  scaler.scale(raw, serial)
+
+  const expected = new ffmpeg.Image('RGBA', width, height)
+  expected.read(serial)
+
+  const images = []
+  const pending = []
+
+  for (let i = 0; i < 4; i++) {
+    const image = new ffmpeg.Image('RGBA', width, height)
+    const frame = new ffmpeg.Frame()
+    image.fill(frame)
+
+    images.push({ image, frame })
+    pending.push(scaler.scaleAsync(raw, frame))
+  }
+
+  await Promise.all(pending)
+
+  for (const { image, frame } of images) {
+    t.alike(image.data, expected.data)
+    frame.destroy()
+  }
+})
+
+test('scaler should accept an algorithm and flags', (t) => {
+  using raw = decodeImage()
+
+  const width = raw.width >> 1
+  const height = raw.height >> 1
+
+  for (const algorithm of ['fast_bilinear', 'point', ffmpeg.constants.scalerAlgorithms.LANCZOS]) {
+    using target = allocFrame(width, height)
+
+    using scaler = new ffmpeg.Scaler(
+      raw.format,
+      raw.width,
+      raw.height,
+      target.format,
+      width,
+      height,
+      {
+        algorithm,
+        flags:
+          ffmpeg.constants.scalerFlags.ACCURATE_RND | ffmpeg.constants.scalerFlags.FULL_CHR_H_INT
+      }
+    )
+
+    t.is(scaler.scale(raw, target), height)
+  }
+
+  using scaler = new ffmpeg.Scaler(raw.format, raw.width, raw.height, 'rgba', width, height, {
+    algorithm: 'area'
+  })
+
+  t.is(scaler.algorithm, ffmpeg.constants.scalerAlgorithms.AREA)
+  t.is(scaler.flags, 0)
+
+  t.exception(
+    () =>
+      new ffmpeg.Scaler(raw.format, raw.width, raw.height, 'rgba', width, height, {
+        algorithm: 'blurry'
+      }),
+    /Unknown scaler algorithm/
+  )
+})
+
+test('scaler colorspace details should change the output', (t) => {
+  using raw = decodeImage()
+
+  using limited = allocFrame(raw.width, raw.height)
+  using full = allocFrame(raw.width, raw.height)
+
+  using limitedScaler = new ffmpeg.Scaler(
+    raw.format,
+    raw.width,
+    raw.height,
+    limited.format,
+    raw.width,
+    raw.height,
+    {
+      sourceRange: ffmpeg.constants.colorRange.MPEG,
+      sourceMatrix: ffmpeg.constants.colorSpace.BT709
+    }
+  )
+
+  using fullScaler = new ffmpeg.Scaler(
+    raw.format,
+    raw.width,
+    raw.height,
+    full.format,
+    raw.width,
+    raw.height,
+    {
+      sourceRange: ffmpeg.constants.colorRange.JPEG,
+      sourceMatrix: ffmpeg.constants.colorSpace.BT709
+    }
+  )
+
+  limitedScaler.scale(raw, limited)
+  fullScaler.scale(raw, full)
+
+  t.absent(Buffer.compare(limited.getPlane(0), full.getPlane(0)) === 0)
+})
+
+// Helpers
+
+function decodeImage() {
+  const image = require('./fixtures/image/sample.jpeg', {
+    with: { type: 'binary' }
+  })
+
+  using io = new ffmpeg.IOContext(image)
+  using format = new ffmpeg.InputFormatContext(io)
+  using packet = new ffmpeg.Packet()
+  format.readFrame(packet)
+
+  using decoder = format.streams[0].decoder()
+  decoder.open()
+  decoder.sendPacket(packet)
+
+  const frame = new ffmpeg.Frame()
+  decoder.receiveFrame(frame)
+
+  return frame
+}
+
+function allocFrame(width, height) {
+  const frame = new ffmpeg.Frame()
+  frame.width = width
+  frame.height = height
+  frame.format = ffmpeg.constants.pixelFormats.RGBA
+  frame.alloc()
+
+  return frame
+}
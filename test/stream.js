@@ -124,6 +124,36 @@ test('it should expose a decoder helper', (t) => {
   t.ok(decoder instanceof ffmpeg.CodecContext)
 })
 
+test('it should expose the keyframe index', (t) => {
+  const video = require('./fixtures/video/sample.mp4', {
+    with: { type: 'binary' }
+  })
+
+  using io = new ffmpeg.IOContext(video)
+  using inputFormatContext = new ffmpeg.InputFormatContext(io)
+  const stream = inputFormatContext.getBestStream(ffmpeg.constants.mediaTypes.VIDEO)
+
+  const entries = stream.indexEntries
+  t.ok(entries.length > 0)
+  t.ok(entries[0].isKeyFrame)
+
+  const entry = stream.findIndexEntry(stream.duration, {
+    flags: ffmpeg.constants.seekFlags.BACKWARD
+  })
+
+  t.ok(entry.isKeyFrame)
+  t.ok(entry.timestamp <= stream.duration)
+
+  const before = entries[0].timestamp - 1
+
+  t.alike(stream.findIndexEntry(before), entries[0], 'forward search picks the first entry')
+  t.is(
+    stream.findIndexEntry(before, { flags: ffmpeg.constants.seekFlags.BACKWARD }),
+    null,
+    'backward search finds nothing before the first entry'
+  )
+})
+
 // Helpers
 
 function getInputFormatContext() {